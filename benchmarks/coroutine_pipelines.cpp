@@ -0,0 +1,159 @@
+/*
+ * ACD Specification - Benchmark: Coroutine Pipelines vs Blocking Threads
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Runs many independent pipelines, each a stream that fills a buffer and
+ * waits for it stage after stage. Once with one host thread driving every
+ * pipeline as a coroutine that co_awaits backend_stream_ready (or records
+ * an event and co_awaits backend_event_done) and resumes through a
+ * backend_resume_queue, and once with a pool of host threads that each
+ * block in backendStreamSynchronize for their share of the pipelines.
+ *
+ * Build: g++ -std=c++20 -O2 -pthread -o coroutine_pipelines coroutine_pipelines.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const int kPipelines = 1000;
+static const int kStages = 20;
+static const size_t kBufferBytes = 4096;
+static const int kBlockingThreads = 16;
+
+typedef std::chrono::steady_clock Clock;
+
+// Fire-and-forget coroutine: starts at once and frees its frame on return.
+struct Pipeline {
+    struct promise_type {
+        Pipeline get_return_object() { return Pipeline(); }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+struct Lane {
+    backend_stream_t stream;
+    backend_event_t event;
+    unsigned char* buffer;
+};
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: One pipeline as a coroutine: each stage queues a fill and suspends until it has retired, on the stream or through an event
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * AI_PATTERN: COROUTINE_AWAIT_V1
+ * TARGET_API_REF: backend_stream_ready(backend_stream_t stream, backend_executor executor) - backend_api.h
+ */
+static Pipeline runPipeline(Lane* lane, bool events, backend_executor executor, int* running) {
+    for (int stage = 0; stage < kStages; ++stage) {
+        backendMemsetAsync(lane->buffer, stage, kBufferBytes, lane->stream);
+        if (events) {
+            backendEventRecord(lane->event, lane->stream);
+            co_await backend_event_done(lane->event, executor);
+        } else {
+            co_await backend_stream_ready(lane->stream, executor);
+        }
+    }
+    --*running;
+}
+
+static double coroutineSeconds(std::vector<Lane>& lanes, bool events) {
+    backend_resume_queue queue;
+    int running = kPipelines;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < kPipelines; ++i) {
+        runPipeline(&lanes[i], events, queue.executor(), &running);
+    }
+    while (running > 0) {
+        queue.run_one();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static double blockingSeconds(std::vector<Lane>& lanes) {
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kBlockingThreads; ++t) {
+        threads.emplace_back([&lanes, t] {
+            for (int stage = 0; stage < kStages; ++stage) {
+                for (int i = t; i < kPipelines; i += kBlockingThreads) {
+                    backendMemsetAsync(lanes[i].buffer, stage, kBufferBytes, lanes[i].stream);
+                    backendStreamSynchronize(lanes[i].stream);
+                }
+            }
+        });
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; prints stage throughput for coroutines on one thread and for blocking threads
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backend_resume_queue::executor() - backend_api.h
+ */
+int main() {
+    std::vector<Lane> lanes(kPipelines);
+    for (int i = 0; i < kPipelines; ++i) {
+        backendStreamCreate(&lanes[i].stream, 0);
+        backendEventCreate(&lanes[i].event, BACKEND_EVENT_DISABLE_TIMING);
+        backendMalloc((void**)&lanes[i].buffer, kBufferBytes);
+    }
+
+    double stream_s = coroutineSeconds(lanes, false);
+    double event_s = coroutineSeconds(lanes, true);
+    double blocking_s = blockingSeconds(lanes);
+    bool filled = true;
+    for (int i = 0; i < kPipelines; ++i) {
+        filled = filled && lanes[i].buffer[kBufferBytes - 1] == kStages - 1;
+    }
+
+    double stages = static_cast<double>(kPipelines) * kStages;
+    printf("Coroutine pipeline benchmark (%d pipelines x %d stages)\n", kPipelines, kStages);
+    printf("  co_await stream, 1 thread:   %8.0f stages/s\n", stages / stream_s);
+    printf("  co_await event, 1 thread:    %8.0f stages/s\n", stages / event_s);
+    printf("  blocking sync, %2d threads:  %8.0f stages/s\n", kBlockingThreads, stages / blocking_s);
+    printf("  buffers filled: %s\n", filled ? "yes" : "NO");
+
+    for (int i = 0; i < kPipelines; ++i) {
+        backendFree(lanes[i].buffer);
+        backendEventDestroy(lanes[i].event);
+        backendStreamDestroy(lanes[i].stream);
+    }
+    return filled ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+/*
+ * ACD Specification - Benchmark: Graph File Warm Start vs Capture and Instantiate
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Times what a starting process spends to reach a launchable 10k-node
+ * pipeline: capture plus backendGraphInstantiate (cold) against
+ * backendGraphExecLoad of a file saved earlier (warm).
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o graph_warm_start graph_warm_start.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const int kNodes = 10000;
+static const int kBranchEvery = 100;   // fork a side stream every N nodes
+static const int kSlice = 256;         // bytes per copy node
+static const int kRepetitions = 11;
+static const char* const kPath = "graph_warm_start.graph";
+
+// Launched only for its ordering; the benchmark times setup, not kernels
+static void pipelineKernel(const backend_kernel_context*, void**) {}
+
+struct Pipeline {
+    std::vector<char> src;
+    std::vector<char> dst;
+    std::vector<void*> args;            // one argument slot per kernel node
+};
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedUs(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Captures and instantiates a kernel/copy/fill pipeline with periodic fork-join branches, as a cold start would
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * TARGET_API_REF: backendGraphInstantiate(backend_graph_exec_t* exec, backend_graph_t graph) - backend_api.h
+ */
+static backend_graph_exec_t buildPipeline(backend_stream_t main_stream, backend_stream_t side_stream,
+                                          backend_event_t fork, backend_event_t join, Pipeline* p) {
+    backend_graph_t graph = NULL;
+    backendStreamBeginCapture(main_stream, &graph);
+    backend_dim3 grid = { 64, 1, 1 };
+    backend_dim3 block = { 256, 1, 1 };
+    for (int i = 0; i < kNodes; ++i) {
+        if (i % kBranchEvery == 0) {
+            backendEventRecord(fork, main_stream);
+            backendStreamWaitEvent(side_stream, fork);
+            backendMemsetAsync(&p->dst[(size_t)i * kSlice], i & 0xFF, kSlice, side_stream);
+            backendEventRecord(join, side_stream);
+            backendStreamWaitEvent(main_stream, join);
+        } else if (i % 3 == 0) {
+            backendLaunchKernel((const void*)pipelineKernel, grid, block, &p->args[i], 0, main_stream);
+        } else {
+            // Every other slice, so consecutive copies never fuse
+            size_t offset = (size_t)i * kSlice;
+            backendMemcpyAsync(&p->dst[offset], &p->src[offset], kSlice / 2,
+                               BACKEND_MEMCPY_DEFAULT, main_stream);
+        }
+    }
+    backendStreamEndCapture(main_stream, &graph);
+    backend_graph_exec_t exec = NULL;
+    backendGraphInstantiate(&exec, graph);
+    backendGraphDestroy(graph);
+    return exec;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; prints median cold and warm start times and checks both executables copy the same bytes
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendGraphExecLoad(backend_graph_exec_t* exec, const char* path) - backend_api.h
+ */
+int main() {
+    backend_stream_t main_stream, side_stream;
+    backend_event_t fork, join;
+    backendStreamCreate(&main_stream, 0);
+    backendStreamCreate(&side_stream, 0);
+    backendEventCreate(&fork, 0);
+    backendEventCreate(&join, 0);
+
+    Pipeline p;
+    p.src.assign((size_t)kNodes * kSlice, 1);
+    p.dst.assign((size_t)kNodes * kSlice, 0);
+    p.args.assign(kNodes, &p);
+    backendRegisterHostKernel((const void*)pipelineKernel, pipelineKernel);
+    backendRegisterKernel((const void*)pipelineKernel, "pipeline_kernel");
+    backendRegisterMemory("src", p.src.data(), p.src.size());
+    backendRegisterMemory("dst", p.dst.data(), p.dst.size());
+    backendRegisterMemory("args", p.args.data(), p.args.size() * sizeof(void*));
+
+    std::vector<double> cold_us;
+    std::vector<double> warm_us;
+    backend_graph_exec_t exec = buildPipeline(main_stream, side_stream, fork, join, &p);
+    if (backendGraphExecSave(exec, kPath) != BACKEND_SUCCESS) {
+        printf("save failed\n");
+        return 1;
+    }
+    for (int r = 0; r < kRepetitions; ++r) {
+        Clock::time_point start = Clock::now();
+        backend_graph_exec_t cold = buildPipeline(main_stream, side_stream, fork, join, &p);
+        cold_us.push_back(elapsedUs(start));
+        backendGraphExecDestroy(cold);
+
+        start = Clock::now();
+        backend_graph_exec_t warm = NULL;
+        backend_error_t result = backendGraphExecLoad(&warm, kPath);
+        warm_us.push_back(elapsedUs(start));
+        if (result != BACKEND_SUCCESS) {
+            printf("load failed: %d\n", result);
+            return 1;
+        }
+        backendGraphExecDestroy(warm);
+    }
+
+    // The loaded exec must copy exactly what the instantiated one copies
+    backendGraphLaunch(exec, main_stream);
+    backendStreamSynchronize(main_stream);
+    std::vector<char> expected = p.dst;
+    std::fill(p.dst.begin(), p.dst.end(), 0);
+    backend_graph_exec_t loaded = NULL;
+    backendGraphExecLoad(&loaded, kPath);
+    backendGraphLaunch(loaded, main_stream);
+    backendStreamSynchronize(main_stream);
+    bool match = expected == p.dst;
+
+    size_t exec_nodes = 0;
+    backendGraphExecGetNodeCount(loaded, &exec_nodes);
+    FILE* file = fopen(kPath, "rb");
+    long file_bytes = 0;
+    if (file != NULL) {
+        fseek(file, 0, SEEK_END);
+        file_bytes = ftell(file);
+        fclose(file);
+    }
+    double cold = median(cold_us);
+    double warm = median(warm_us);
+    printf("Graph warm start benchmark (%d captured nodes, %zu after optimization, %ld byte file)\n",
+           kNodes, exec_nodes, file_bytes);
+    printf("  capture + instantiate: %10.1f us (median of %d)\n", cold, kRepetitions);
+    printf("  load:                  %10.1f us (median of %d)\n", warm, kRepetitions);
+    printf("  speedup:               %10.1fx\n", cold / warm);
+    printf("  results match: %s\n", match ? "yes" : "NO");
+
+    remove(kPath);
+    backendGraphExecDestroy(loaded);
+    backendGraphExecDestroy(exec);
+    backendEventDestroy(fork);
+    backendEventDestroy(join);
+    backendStreamDestroy(side_stream);
+    backendStreamDestroy(main_stream);
+    return match ? 0 : 1;
+}
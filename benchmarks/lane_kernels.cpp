@@ -0,0 +1,167 @@
+/*
+ * ACD Specification - Benchmark: Lane Kernels vs Per-Thread Host Kernels
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Times one saxpy launch (y = a*x + y over 16M floats, 256 threads per
+ * block, ragged last block) written three ways: a host kernel that calls
+ * a per-thread function for each thread, the same thread function
+ * registered as a lane kernel, and a host kernel hand-written as one
+ * vectorizable loop per block.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o lane_kernels lane_kernels.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const unsigned int kCount = (16u << 20) - 100;   // last block is partial
+static const unsigned int kBlock = 256;
+static const int kRepetitions = 11;
+
+struct Saxpy {
+    struct Params {
+        float a;
+        const float* x;
+        float* y;
+        unsigned int live;
+    };
+
+    static Params load(const backend_kernel_context* ctx, void** args) {
+        size_t first = (size_t)ctx->blockIdx.x * ctx->blockDim.x;
+        unsigned int count = *(unsigned int*)args[3];
+        Params p;
+        p.a = *(float*)args[0];
+        p.x = *(const float**)args[1] + first;
+        p.y = *(float**)args[2] + first;
+        p.live = first < count ? (unsigned int)std::min<size_t>(count - first, ctx->blockDim.x) : 0;
+        return p;
+    }
+
+    static unsigned int live(const Params& p, const backend_kernel_context*) {
+        return p.live;
+    }
+
+    static void thread(const Params& p, const backend_kernel_context*, unsigned int t, bool active) {
+        if (active) {
+            p.y[t] = p.a * p.x[t] + p.y[t];
+        }
+    }
+};
+
+// One call per thread, as a direct translation of the device kernel would make
+static void (*volatile perThread)(const Saxpy::Params&, const backend_kernel_context*, unsigned int,
+                                  bool) = Saxpy::thread;
+
+static void threadKernel(const backend_kernel_context* ctx, void** args) {
+    Saxpy::Params p = Saxpy::load(ctx, args);
+    for (unsigned int t = 0; t < p.live; ++t) {
+        perThread(p, ctx, t, true);
+    }
+}
+
+static void handKernel(const backend_kernel_context* ctx, void** args) {
+    Saxpy::Params p = Saxpy::load(ctx, args);
+    const float* __restrict x = p.x;
+    float* __restrict y = p.y;
+    for (unsigned int t = 0; t < p.live; ++t) {
+        y[t] = p.a * x[t] + y[t];
+    }
+}
+
+static void* const kThreadFunc = (void*)0x1000;
+static void* const kLaneFunc = (void*)0x2000;
+static void* const kHandFunc = (void*)0x3000;
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Median wall time of one synchronized saxpy launch of func
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendLaunchKernel(const void* func, backend_dim3 grid, backend_dim3 block, void** args, size_t sharedMem, backend_stream_t stream) - backend_api.h
+ */
+static double timeLaunch(const void* func, void** args, backend_stream_t stream) {
+    backend_dim3 grid = { (kCount + kBlock - 1) / kBlock, 1, 1 };
+    backend_dim3 block = { kBlock, 1, 1 };
+    std::vector<double> samples;
+    for (int r = 0; r < kRepetitions; ++r) {
+        Clock::time_point start = Clock::now();
+        backendLaunchKernel(func, grid, block, args, 0, stream);
+        backendStreamSynchronize(stream);
+        samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; prints median launch times and checks all three kernels compute the same y
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendRegisterLaneKernel<Body, BlockSize, Width>(const void* func) - backend_api.h
+ */
+int main() {
+    backend_stream_t stream;
+    backendStreamCreate(&stream, 0);
+    backendRegisterHostKernel(kThreadFunc, threadKernel);
+    backendRegisterLaneKernel<Saxpy, kBlock>(kLaneFunc);
+    backendRegisterHostKernel(kHandFunc, handKernel);
+
+    std::vector<float> x(kCount), y[3];
+    for (unsigned int i = 0; i < kCount; ++i) {
+        x[i] = (float)(i % 1000);
+    }
+    float a = 0.5f;
+    const float* x_ptr = x.data();
+    unsigned int count = kCount;
+    const void* funcs[3] = { kThreadFunc, kLaneFunc, kHandFunc };
+    double ms[3];
+    for (int k = 0; k < 3; ++k) {
+        y[k].assign(kCount, 1.0f);
+        float* y_ptr = y[k].data();
+        void* args[] = { &a, &x_ptr, &y_ptr, &count };
+        ms[k] = timeLaunch(funcs[k], args, stream);
+    }
+    bool match = y[0] == y[1] && y[1] == y[2];
+
+    printf("Lane kernel benchmark (saxpy, %u elements, %u threads per block, %u lanes)\n",
+           kCount, kBlock, (unsigned int)BACKEND_LANE_WIDTH);
+    printf("  per-thread calls: %8.2f ms (median of %d)\n", ms[0], kRepetitions);
+    printf("  lane kernel:      %8.2f ms\n", ms[1]);
+    printf("  hand-vectorized:  %8.2f ms\n", ms[2]);
+    printf("  lane speedup:     %8.1fx\n", ms[0] / ms[1]);
+    printf("  results match: %s\n", match ? "yes" : "NO");
+
+    backendStreamDestroy(stream);
+    return match ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+ * ACD Specification - Benchmark: Typed Launch Arguments vs Boxed void** Arguments
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Launches a one-block kernel whose scalar argument changes every launch.
+ * With backendLaunchKernel each launch boxes its arguments into storage
+ * that must outlive the launch; with backendLaunch they travel by value
+ * in the stream op. Times the host side of a launch (the stream is held
+ * behind a callback so workers do not compete) and a launch end to end
+ * as a node of a replayed graph.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o launch_args launch_args.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const int kLaunches = 100000;
+static const int kGraphNodes = 10000;
+static const int kRepetitions = 11;
+
+struct Boxed {
+    float* acc;
+    float x;
+    float y;
+    void* slots[3];
+};
+
+static void boxedKernel(const backend_kernel_context*, void** args) {
+    float* acc = *(float**)args[0];
+    *acc += *(float*)args[1] * *(float*)args[2];
+}
+
+static void typedKernel(const backend_kernel_context*, float* acc, float x, float y) {
+    *acc += x * y;
+}
+
+static Boxed* box(float* acc, float x, float y) {
+    Boxed* b = new Boxed;
+    b->acc = acc;
+    b->x = x;
+    b->y = y;
+    b->slots[0] = &b->acc;
+    b->slots[1] = &b->x;
+    b->slots[2] = &b->y;
+    return b;
+}
+
+static std::atomic<bool> holding(false);
+
+static void holdStream(backend_stream_t, backend_error_t, void*) {
+    while (holding.load()) {
+        std::this_thread::yield();
+    }
+}
+
+typedef std::chrono::steady_clock Clock;
+
+static double nsPer(Clock::time_point start, int count) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Host time per launch call with the stream held, so only validation, argument handling and queueing are measured
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendLaunch(void (*kernel)(const backend_kernel_context*, Params...), backend_dim3 grid, backend_dim3 block, size_t sharedMem, backend_stream_t stream, Params... args) - backend_api.h
+ */
+static double enqueueNs(bool typed, backend_stream_t stream, float* acc) {
+    backend_dim3 one = { 1, 1, 1 };
+    std::vector<Boxed*> boxes;
+    boxes.reserve(kLaunches);
+    holding = true;
+    backendStreamAddCallback(stream, holdStream, NULL);
+    Clock::time_point start = Clock::now();
+    if (typed) {
+        for (int i = 0; i < kLaunches; ++i) {
+            backendLaunch(typedKernel, one, one, 0, stream, acc, (float)i, 1.0f);
+        }
+    } else {
+        for (int i = 0; i < kLaunches; ++i) {
+            boxes.push_back(box(acc, (float)i, 1.0f));
+            backendLaunchKernel((void*)boxedKernel, one, one, boxes.back()->slots, 0, stream);
+        }
+    }
+    double ns = nsPer(start, kLaunches);
+    holding = false;
+    backendStreamSynchronize(stream);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        delete boxes[i];
+    }
+    return ns;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Time per kernel node of a replayed chain graph, i.e. executing a launch and unpacking its arguments without queueing
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, GRAPH_TRANSLATION
+ * TARGET_API_REF: backendGraphLaunch(backend_graph_exec_t exec, backend_stream_t stream) - backend_api.h
+ */
+static double nodeNs(bool typed, backend_stream_t stream, float* acc) {
+    backend_dim3 one = { 1, 1, 1 };
+    std::vector<Boxed*> boxes;
+    backend_graph_t graph = NULL;
+    backendStreamBeginCapture(stream, &graph);
+    for (int i = 0; i < kGraphNodes; ++i) {
+        if (typed) {
+            backendLaunch(typedKernel, one, one, 0, stream, acc, (float)i, 1.0f);
+        } else {
+            boxes.push_back(box(acc, (float)i, 1.0f));
+            backendLaunchKernel((void*)boxedKernel, one, one, boxes.back()->slots, 0, stream);
+        }
+    }
+    backendStreamEndCapture(stream, &graph);
+    backend_graph_exec_t exec = NULL;
+    backendGraphInstantiate(&exec, graph);
+    std::vector<double> samples;
+    for (int r = 0; r < kRepetitions; ++r) {
+        Clock::time_point start = Clock::now();
+        backendGraphLaunch(exec, stream);
+        backendStreamSynchronize(stream);
+        samples.push_back(nsPer(start, kGraphNodes));
+    }
+    backendGraphExecDestroy(exec);
+    backendGraphDestroy(graph);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        delete boxes[i];
+    }
+    return median(samples);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; prints median per-launch costs for both argument paths and checks they accumulate the same value
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendLaunchKernel(const void* func, backend_dim3 grid, backend_dim3 block, void** args, size_t sharedMem, backend_stream_t stream) - backend_api.h
+ */
+int main() {
+    backend_stream_t stream;
+    backendStreamCreate(&stream, 0);
+    backendRegisterHostKernel((void*)boxedKernel, boxedKernel);
+
+    float acc[2] = { 0.0f, 0.0f };
+    std::vector<double> enqueue[2];
+    for (int r = 0; r < kRepetitions; ++r) {
+        for (int typed = 0; typed < 2; ++typed) {
+            enqueue[typed].push_back(enqueueNs(typed != 0, stream, &acc[typed]));
+        }
+    }
+    double node[2];
+    for (int typed = 0; typed < 2; ++typed) {
+        node[typed] = nodeNs(typed != 0, stream, &acc[typed]);
+    }
+    bool match = acc[0] == acc[1];
+
+    printf("Launch argument benchmark (one-block kernel, three arguments, new values each launch)\n");
+    printf("                   boxed void**   typed\n");
+    printf("  launch call:     %9.1f ns  %7.1f ns  (median of %d x %d launches)\n",
+           median(enqueue[0]), median(enqueue[1]), kRepetitions, kLaunches);
+    printf("  graph node:      %9.1f ns  %7.1f ns  (median of %d x %d nodes)\n",
+           node[0], node[1], kRepetitions, kGraphNodes);
+    printf("  results match: %s\n", match ? "yes" : "NO");
+
+    backendStreamDestroy(stream);
+    return match ? 0 : 1;
+}
@@ -0,0 +1,148 @@
+/*
+ * ACD Specification - Benchmark: Peer Copy Bandwidth Matrix
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Splits the host into devices (BACKEND_DEVICES, or the first argument,
+ * default "4") and copies a buffer between every pair with
+ * backendMemcpyPeerAsync on a stream of the destination device. Prints a
+ * GB/s matrix with peer access disabled, where copies stage through a
+ * bounce buffer, and one with access enabled, where they go arena to arena.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o peer_bandwidth peer_bandwidth.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static const size_t kCopyBytes = 32u << 20;
+static const int kRepetitions = 5;
+
+typedef std::chrono::steady_clock Clock;
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Best-of-N bandwidth of one src -> dst peer copy, in GB/s
+ * AI_DEPENDENCIES: PEER_MEMORY_ACCESS, STREAM_TRANSLATION
+ * TARGET_API_REF: backendMemcpyPeerAsync(void* dst, int dstDevice, const void* src, int srcDevice, size_t sizeBytes, backend_stream_t stream) - backend_api.h
+ */
+static double copyGBs(const std::vector<void*>& sources, const std::vector<void*>& targets, int dst, int src,
+                      backend_stream_t stream) {
+    double best = 0.0;
+    for (int r = 0; r < kRepetitions; ++r) {
+        Clock::time_point start = Clock::now();
+        backendMemcpyPeerAsync(targets[dst], dst, sources[src], src, kCopyBytes, stream);
+        backendStreamSynchronize(stream);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        best = std::max(best, kCopyBytes / seconds / 1e9);
+    }
+    return best;
+}
+
+static void printMatrix(const char* title, const std::vector<double>& gbs, int count) {
+    printf("\n  %s (GB/s, rows: source, columns: destination)\n        ", title);
+    for (int dst = 0; dst < count; ++dst) {
+        printf("  dev %-3d", dst);
+    }
+    printf("\n");
+    for (int src = 0; src < count; ++src) {
+        printf("  dev %-2d", src);
+        for (int dst = 0; dst < count; ++dst) {
+            printf(" %8.2f", gbs[src * count + dst]);
+        }
+        printf("\n");
+    }
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; measures every device pair staged, enables all peer access, then measures them direct
+ * AI_DEPENDENCIES: PEER_MEMORY_ACCESS, DEVICE_QUERY
+ * TARGET_API_REF: backendDeviceEnablePeerAccess(int peerDevice, unsigned int flags) - backend_api.h
+ */
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        backendConfigureDevices(argv[1]);
+    } else if (getenv("BACKEND_DEVICES") == NULL) {
+        backendConfigureDevices("4");
+    }
+    int count = 0;
+    backendGetDeviceCount(&count);
+
+    std::vector<void*> sources(count), targets(count);
+    std::vector<backend_stream_t> streams(count);
+    for (int d = 0; d < count; ++d) {
+        backendSetDevice(d);
+        if (backendMalloc(&sources[d], kCopyBytes) != BACKEND_SUCCESS ||
+            backendMalloc(&targets[d], kCopyBytes) != BACKEND_SUCCESS) {
+            fprintf(stderr, "out of memory on device %d\n", d);
+            return 1;
+        }
+        memset(sources[d], d + 1, kCopyBytes);
+        memset(targets[d], 0, kCopyBytes);
+        backendStreamCreate(&streams[d], 0);
+    }
+
+    std::vector<double> staged(count * count), direct(count * count);
+    for (int src = 0; src < count; ++src) {
+        for (int dst = 0; dst < count; ++dst) {
+            staged[src * count + dst] = copyGBs(sources, targets, dst, src, streams[dst]);
+        }
+    }
+    for (int d = 0; d < count; ++d) {
+        backendSetDevice(d);
+        for (int peer = 0; peer < count; ++peer) {
+            if (peer != d) {
+                backendDeviceEnablePeerAccess(peer, 0);
+            }
+        }
+    }
+    for (int src = 0; src < count; ++src) {
+        for (int dst = 0; dst < count; ++dst) {
+            direct[src * count + dst] = copyGBs(sources, targets, dst, src, streams[dst]);
+        }
+    }
+
+    printf("Peer copy bandwidth benchmark (%d devices, %zu MiB per copy, best of %d)\n",
+           count, kCopyBytes >> 20, kRepetitions);
+    printMatrix("peer access disabled, staged", staged, count);
+    printMatrix("peer access enabled, direct", direct, count);
+
+    for (int d = 0; d < count; ++d) {
+        backendStreamDestroy(streams[d]);
+        backendFree(sources[d]);
+        backendFree(targets[d]);
+    }
+    return 0;
+}
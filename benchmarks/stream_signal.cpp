@@ -0,0 +1,171 @@
+/*
+ * ACD Specification - Benchmark: Stream Value Signalling vs Events
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * Two streams play ping-pong: each round, stream A signals B, B runs a
+ * one-block kernel and signals back, and A waits for that before its next
+ * round. Signals are event record/wait pairs, or writeValue/waitValue on
+ * two counters. All rounds are queued while A is held behind a callback,
+ * so the host cost of queueing a round and the time the workers take to
+ * play it are measured separately.
+ *
+ * Build: g++ -std=c++17 -O2 -pthread -o stream_signal stream_signal.cpp
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ */
+
+#include "../src/backend_api.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static const int kRounds = 20000;
+static const int kRepetitions = 11;
+
+typedef std::chrono::steady_clock Clock;
+
+struct RoundCost {
+    double queue_ns;    // host time to queue one round
+    double play_ns;     // worker time to play one round
+};
+
+static std::atomic<bool> holding(false);
+
+static void holdStream(backend_stream_t, backend_error_t, void*) {
+    while (holding.load()) {
+        std::this_thread::yield();
+    }
+}
+
+static void bump(const backend_kernel_context*, int* counter) {
+    ++*counter;
+}
+
+static double nsPer(Clock::time_point start, int count) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+}
+
+static double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Queues kRounds rounds with enqueue(i) behind a hold on stream A, then releases A and times the rounds until A has played the last one
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendEventSynchronize(backend_event_t event) - backend_api.h
+ */
+template <typename Enqueue>
+static RoundCost measure(backend_stream_t a, backend_stream_t b, Enqueue enqueue) {
+    RoundCost cost;
+    holding = true;
+    backendStreamAddCallback(a, holdStream, NULL);
+    Clock::time_point start = Clock::now();
+    for (int i = 1; i <= kRounds; ++i) {
+        enqueue(i);
+    }
+    cost.queue_ns = nsPer(start, kRounds);
+    // A stream synchronize would be woken by every retired op; an event
+    // recorded behind the last round wakes the host once
+    backend_event_t done;
+    backendEventCreate(&done, BACKEND_EVENT_DISABLE_TIMING);
+    backendEventRecord(done, a);
+    start = Clock::now();
+    holding = false;
+    backendEventSynchronize(done);
+    cost.play_ns = nsPer(start, kRounds);
+    backendEventDestroy(done);
+    backendStreamSynchronize(b);
+    return cost;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Benchmark driver; prints median host and worker time per ping-pong round for both signalling methods and checks every round ran its kernel
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * TARGET_API_REF: backendStreamWaitValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value, unsigned int flags) - backend_api.h
+ */
+int main() {
+    backend_stream_t a, b;
+    backendStreamCreate(&a, 0);
+    backendStreamCreate(&b, 0);
+    backend_dim3 one = { 1, 1, 1 };
+
+    // One event per direction, re-recorded every round; each wait
+    // snapshots the record queued just before it
+    backend_event_t ping_event, pong_event;
+    backendEventCreate(&ping_event, BACKEND_EVENT_DISABLE_TIMING);
+    backendEventCreate(&pong_event, BACKEND_EVENT_DISABLE_TIMING);
+    // One counter per direction; round i writes i and the other side
+    // waits for >= i
+    uint32_t ping = 0;
+    uint32_t pong = 0;
+
+    int counters[2] = { 0, 0 };
+    std::vector<double> queue_ns[2];
+    std::vector<double> play_ns[2];
+    for (int r = 0; r < kRepetitions; ++r) {
+        RoundCost events = measure(a, b, [&](int) {
+            backendEventRecord(ping_event, a);
+            backendStreamWaitEvent(b, ping_event);
+            backendLaunch(bump, one, one, 0, b, &counters[0]);
+            backendEventRecord(pong_event, b);
+            backendStreamWaitEvent(a, pong_event);
+        });
+        uint32_t base = ping;
+        RoundCost values = measure(a, b, [&](int i) {
+            backendStreamWriteValue32(a, &ping, base + i, 0);
+            backendStreamWaitValue32(b, &ping, base + i, BACKEND_STREAM_WAIT_VALUE_GEQ);
+            backendLaunch(bump, one, one, 0, b, &counters[1]);
+            backendStreamWriteValue32(b, &pong, base + i, 0);
+            backendStreamWaitValue32(a, &pong, base + i, BACKEND_STREAM_WAIT_VALUE_GEQ);
+        });
+        queue_ns[0].push_back(events.queue_ns);
+        play_ns[0].push_back(events.play_ns);
+        queue_ns[1].push_back(values.queue_ns);
+        play_ns[1].push_back(values.play_ns);
+    }
+    bool match = counters[0] == kRounds * kRepetitions && counters[1] == counters[0];
+
+    printf("Stream signalling benchmark (%d ping-pong rounds between two streams, median of %d)\n",
+           kRounds, kRepetitions);
+    printf("                          queue       play\n");
+    printf("  event record/wait:   %7.1f ns %8.1f ns per round\n", median(queue_ns[0]), median(play_ns[0]));
+    printf("  writeValue/waitValue:%7.1f ns %8.1f ns per round\n", median(queue_ns[1]), median(play_ns[1]));
+    printf("  every round ran: %s\n", match ? "yes" : "NO");
+
+    backendEventDestroy(pong_event);
+    backendEventDestroy(ping_event);
+    backendStreamDestroy(b);
+    backendStreamDestroy(a);
+    return match ? 0 : 1;
+}
@@ -31,6 +31,7 @@
  */
 
 #include "../src/ai_metadata.h"
+#include "../src/backend_api.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -38,6 +39,9 @@
 // Generic API type definitions
 typedef int api_error_t;
 typedef void* api_stream_t;
+typedef void* api_graph_t;
+typedef void* api_graph_exec_t;
+typedef void* api_graph_conditional_t;
 
 // Error codes
 #define API_SUCCESS 0
@@ -45,6 +49,17 @@ typedef void* api_stream_t;
 #define API_ERROR_MEMORY_ALLOCATION -2
 #define API_ERROR_NOT_IMPLEMENTED -3
 
+// Conditional node types
+#define API_GRAPH_COND_IF 0
+#define API_GRAPH_COND_WHILE 1
+
+static api_error_t backendErrorToApiError(backend_error_t result) {
+    if (result == BACKEND_SUCCESS) {
+        return API_SUCCESS;
+    }
+    return result == BACKEND_ERROR_OUT_OF_MEMORY ? API_ERROR_MEMORY_ALLOCATION
+                                                 : API_ERROR_INVALID_VALUE;
+}
 
 /* Example 1: Simple device query function */
 /*
@@ -53,15 +68,15 @@ typedef void* api_stream_t;
  * AI_COMPLEXITY: LOW
  * AI_NOTE: Queries the number of available devices
  * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendGetDeviceCount(int* count) - backend_api.h
  */
 int getDeviceCount(int* count) {
     if (count == NULL) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Mock implementation - in real code, this would query the backend
-    *count = 1;
-    return API_SUCCESS;
+    backend_error_t result = backendGetDeviceCount(count);
+    return backendErrorToApiError(result);
 }
 
 
@@ -72,17 +87,56 @@ int getDeviceCount(int* count) {
  * AI_COMPLEXITY: MEDIUM
  * AI_NOTE: Retrieves device properties with backend translation
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_STRATEGY: The backend publishes its properties once, so querying on every request costs a pointer load; the result is never copied
  * SOURCE_API_REF: getDeviceProperties(int device) - generic_api.h
- * TARGET_API_REF: backendGetDeviceProperties(int device) - backend_api.h
+ * TARGET_API_REF: backendGetDeviceProperties(const backend_device_properties** props, int device) - backend_api.h
  */
 int getDeviceProperties(int device) {
     if (device < 0) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Mock implementation
-    printf("Device %d properties queried\n", device);
-    return API_SUCCESS;
+    const backend_device_properties* props = NULL;
+    backend_error_t result = backendGetDeviceProperties(&props, device);
+    if (result == BACKEND_SUCCESS) {
+        printf("Device %d: %s, %u workers, %zu KiB L2\n", device, props->name,
+               props->multiProcessorCount, props->l2CacheSize / 1024);
+    }
+    return backendErrorToApiError(result);
+}
+
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Selects the device later streams and allocations of this thread use
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: The backend keeps the current device in a thread-local, so switching devices per request is cheap
+ * SOURCE_API_REF: setDevice(int device) - generic_api.h
+ * TARGET_API_REF: backendSetDevice(int device) - backend_api.h
+ */
+int setDevice(int device) {
+    backend_error_t result = backendSetDevice(device);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports this thread's current device
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * SOURCE_API_REF: getDevice(int* device) - generic_api.h
+ * TARGET_API_REF: backendGetDevice(int* device) - backend_api.h
+ */
+int getDevice(int* device) {
+    if (device == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGetDevice(device);
+    return backendErrorToApiError(result);
 }
 
 
@@ -97,6 +151,7 @@ int getDeviceProperties(int device) {
  * AI_COMMIT_HISTORY: d6e5f4c, a3b2c1d
  * AI_PATTERN: KERNEL_LAUNCH_V1
  * AI_STRATEGY: Direct translation with parameter validation and error handling
+ * AI_CHANGE: Launches are enqueued on the backend stream, so they are recorded while the stream captures
  * SOURCE_API_REF: launchKernel(func, grid, block, args, sharedMem, stream) - generic_api.h
  * TARGET_API_REF: backendLaunchKernel(func, grid, block, args, sharedMem, stream) - backend_api.h
  */
@@ -112,45 +167,452 @@ int launchKernel(void* func, int gridX, int gridY, int gridZ,
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Mock implementation
-    printf("Kernel launched: grid(%d,%d,%d) block(%d,%d,%d) sharedMem=%zu\n",
-           gridX, gridY, gridZ, blockX, blockY, blockZ, sharedMem);
-    return API_SUCCESS;
+    backend_dim3 grid = { (unsigned int)gridX, (unsigned int)gridY, (unsigned int)gridZ };
+    backend_dim3 block = { (unsigned int)blockX, (unsigned int)blockY, (unsigned int)blockZ };
+    backend_error_t result = backendLaunchKernel(func, grid, block, args, sharedMem,
+                                                 (backend_stream_t)stream);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Blocks of a kernel that run at once with the given block size and dynamic shared memory
+ * AI_DEPENDENCIES: KERNEL_DISPATCH, DEVICE_QUERY
+ * AI_PATTERN: KERNEL_LAUNCH_V1
+ * AI_STRATEGY: The backend answers from its worker count and the L1/L2 sizes it read from sysfs, weighed against the kernel's declared shared memory
+ * SOURCE_API_REF: occupancyMaxActiveBlocks(numBlocks, func, blockSize, sharedMem) - generic_api.h
+ * TARGET_API_REF: backendOccupancyMaxActiveBlocks(blocks, func, blockSize, sharedMem) - backend_api.h
+ */
+int occupancyMaxActiveBlocks(int* numBlocks, void* func, int blockSize, size_t sharedMem) {
+    if (numBlocks == NULL || func == NULL || blockSize <= 0) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    unsigned int blocks = 0;
+    backend_error_t result = backendOccupancyMaxActiveBlocks(&blocks, func, (unsigned int)blockSize,
+                                                             sharedMem);
+    *numBlocks = (int)blocks;
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Picks block and grid sizes for a one-thread-per-element launch over n elements
+ * AI_DEPENDENCIES: KERNEL_DISPATCH, DEVICE_QUERY
+ * AI_PATTERN: KERNEL_LAUNCH_V1
+ * AI_STRATEGY: Replaces hand-tuned dims: the backend weighs block dispatch overhead against keeping every worker busy
+ * SOURCE_API_REF: suggestLaunchConfig(func, sharedMem, n, gridSize, blockSize) - generic_api.h
+ * TARGET_API_REF: backendSuggestLaunchConfig(config, func, sharedMem, n) - backend_api.h
+ */
+int suggestLaunchConfig(void* func, size_t sharedMem, size_t n, int* gridSize, int* blockSize) {
+    if (func == NULL || gridSize == NULL || blockSize == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_launch_config config;
+    backend_error_t result = backendSuggestLaunchConfig(&config, func, sharedMem, n);
+    if (result == BACKEND_SUCCESS) {
+        *gridSize = (int)config.gridSize;
+        *blockSize = (int)config.blockSize;
+    }
+    return backendErrorToApiError(result);
 }
 
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Launches many small kernels, in order, as one stream operation
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: KERNEL_LAUNCH_V1
+ * AI_STRATEGY: The batch is validated as a whole and queued once; a worker runs the kernels back to back, so per-kernel scheduling cost disappears for tiny kernels
+ * SOURCE_API_REF: launchKernelBatch(launches, count, stream) - generic_api.h
+ * TARGET_API_REF: backendLaunchKernelBatch(launches, count, stream) - backend_api.h
+ */
+int launchKernelBatch(const backend_launch_params* launches, int count, api_stream_t stream) {
+    if (launches == NULL || count <= 0) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendLaunchKernelBatch(launches, (unsigned int)count,
+                                                      (backend_stream_t)stream);
+    return backendErrorToApiError(result);
+}
 
-/* Example 4: Partial implementation */
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Hands one work item to a persistent kernel serving the queue
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: KERNEL_LAUNCH_V1
+ * AI_STRATEGY: The item goes through a lock-free ring the kernel's blocks are already polling, so no launch is paid per item; a full queue refuses the item rather than blocking the caller
+ * SOURCE_API_REF: pushWork(queue, item) - generic_api.h
+ * TARGET_API_REF: backendWorkQueuePush(queue, item) - backend_api.h
+ */
+int pushWork(backend_work_queue_t queue, void* item) {
+    if (queue == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendWorkQueuePush(queue, item);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Launches a kernel whose blocks may synchronize the whole grid between phases
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: KERNEL_LAUNCH_V1
+ * AI_STRATEGY: Blocks are guaranteed co-resident, so a reduce-then-normalize kernel needs one launch instead of two; grids above the backend's cooperative limit are rejected
+ * SOURCE_API_REF: launchCooperativeKernel(func, gridX, blockX, args, sharedMem, stream) - generic_api.h
+ * TARGET_API_REF: backendLaunchCooperativeKernel(func, grid, block, args, sharedMem, stream) - backend_api.h
+ */
+int launchCooperativeKernel(void* func, int gridX, int blockX,
+                            void** args, size_t sharedMem, api_stream_t stream) {
+    if (func == NULL || gridX <= 0 || blockX <= 0) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_dim3 grid = { (unsigned int)gridX, 1, 1 };
+    backend_dim3 block = { (unsigned int)blockX, 1, 1 };
+    backend_error_t result = backendLaunchCooperativeKernel(func, grid, block, args, sharedMem,
+                                                            (backend_stream_t)stream);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Binds a kernel handle to the host function that executes one block of it
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Kernels run on the host backend's workers; launching a handle that was never registered fails
+ * SOURCE_API_REF: registerHostKernel(void* func, backend_host_kernel_t kernel) - generic_api.h
+ * TARGET_API_REF: backendRegisterHostKernel(const void* func, backend_host_kernel_t kernel) - backend_api.h
+ */
+int registerHostKernel(void* func, backend_host_kernel_t kernel) {
+    if (func == NULL || kernel == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendRegisterHostKernel(func, kernel);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Declares the per-block shared memory a registered kernel uses for its tiles
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Blocks reach it through ctx->sharedMem, carved from the worker's reusable arena instead of a per-block allocation
+ * SOURCE_API_REF: setKernelSharedMemory(void* func, size_t bytes) - generic_api.h
+ * TARGET_API_REF: backendFuncSetStaticSharedMem(const void* func, size_t bytes) - backend_api.h
+ */
+int setKernelSharedMemory(void* func, size_t bytes) {
+    if (func == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendFuncSetStaticSharedMem(func, bytes);
+    return backendErrorToApiError(result);
+}
+
+
+/* Example 4: Stream capture */
 /*
  * AI_PHASE: GRAPH_TRANSLATION
- * AI_STATUS: PARTIAL
+ * AI_STATUS: IMPLEMENTED
  * AI_COMPLEXITY: CRITICAL
- * AI_NOTE: Graph capture implementation in progress - basic structure only, missing node optimization
+ * AI_NOTE: Starts recording the stream's copies, fills, kernel launches and callbacks into a task graph instead of executing them
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * AI_PATTERN: STREAM_CAPTURE_V1
+ * AI_STRATEGY: Capture is a backend stream mode; recordEvent/streamWaitEvent during capture fork and join other streams into the same graph
+ * AI_CHANGE: Was a stub returning NOT_IMPLEMENTED; graph receives the handle of the graph being captured
+ * SOURCE_API_REF: captureGraphBegin(void** graph, api_stream_t stream) - generic_api.h
+ * TARGET_API_REF: backendStreamBeginCapture(backend_stream_t stream, backend_graph_t* graph) - backend_api.h
  */
 int captureGraphBegin(void** graph, api_stream_t stream) {
-    if (graph == NULL) {
+    if (graph == NULL || stream == NULL) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    // TODO: Implement full graph capture logic
-    printf("Graph capture begin (PARTIAL IMPLEMENTATION)\n");
-    return API_ERROR_NOT_IMPLEMENTED;
+    backend_error_t result = backendStreamBeginCapture((backend_stream_t)stream, (backend_graph_t*)graph);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Ends capture on the stream that began it and returns the captured graph
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * AI_PATTERN: STREAM_CAPTURE_V1
+ * AI_STRATEGY: Streams that joined through events are detached too; an invalidated capture yields no graph and an error
+ * SOURCE_API_REF: endCapture(api_stream_t stream, api_graph_t* graph) - generic_api.h
+ * TARGET_API_REF: backendStreamEndCapture(backend_stream_t stream, backend_graph_t* graph) - backend_api.h
+ */
+int endCapture(api_stream_t stream, api_graph_t* graph) {
+    if (stream == NULL || graph == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendStreamEndCapture((backend_stream_t)stream, (backend_graph_t*)graph);
+    return backendErrorToApiError(result);
 }
 
 
-/* Example 5: Not started implementation */
+/* Example 5: Graph instantiation and replay */
 /*
  * AI_PHASE: GRAPH_TRANSLATION
- * AI_STATUS: NOT_STARTED
+ * AI_STATUS: IMPLEMENTED
  * AI_COMPLEXITY: HIGH
- * AI_NOTE: Placeholder for graph instantiation - requires graph capture to be completed first
+ * AI_NOTE: Turns a captured graph into an executable graph that can be launched repeatedly
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_INSTANTIATE_V1
+ * AI_STRATEGY: Dependencies are flattened once here so each launch only resets per-node counters
+ * AI_CHANGE: Was a placeholder; now takes an output handle for the executable graph
+ * SOURCE_API_REF: instantiateGraph(api_graph_exec_t* graphExec, api_graph_t graph) - generic_api.h
+ * TARGET_API_REF: backendGraphInstantiate(backend_graph_exec_t* exec, backend_graph_t graph) - backend_api.h
  */
-int instantiateGraph(void* graph) {
+int instantiateGraph(api_graph_exec_t* graphExec, api_graph_t graph) {
+    if (graphExec == NULL || graph == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphInstantiate((backend_graph_exec_t*)graphExec, (backend_graph_t)graph);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Replays an executable graph on a stream with a single submission
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_LAUNCH_V1
+ * AI_STRATEGY: The whole graph is one stream operation; independent nodes run concurrently on the backend workers
+ * SOURCE_API_REF: launchGraph(api_graph_exec_t graphExec, api_stream_t stream) - generic_api.h
+ * TARGET_API_REF: backendGraphLaunch(backend_graph_exec_t exec, backend_stream_t stream) - backend_api.h
+ */
+int launchGraph(api_graph_exec_t graphExec, api_stream_t stream) {
+    if (graphExec == NULL || stream == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphLaunch((backend_graph_exec_t)graphExec, (backend_stream_t)stream);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Updates an executable graph in place with the node parameters of a graph of the same topology
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_EXEC_UPDATE_V1
+ * AI_STRATEGY: Avoids re-instantiation and re-optimization when only kernel arguments or copy pointers changed; on rejection the caller instantiates instead
+ * SOURCE_API_REF: graphExecUpdate(api_graph_exec_t graphExec, api_graph_t graph) - generic_api.h
+ * TARGET_API_REF: backendGraphExecUpdate(backend_graph_exec_t exec, backend_graph_t graph) - backend_api.h
+ */
+int graphExecUpdate(api_graph_exec_t graphExec, api_graph_t graph) {
+    if (graphExec == NULL || graph == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphExecUpdate((backend_graph_exec_t)graphExec, (backend_graph_t)graph);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Creates a conditional value in a graph; the value selects whether if/while nodes run their body
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * AI_STRATEGY: resetEachLaunch maps to BACKEND_GRAPH_COND_ASSIGN_DEFAULT, so every launch of a loop starts from defaultValue
+ * SOURCE_API_REF: createGraphConditional(api_graph_conditional_t* cond, api_graph_t graph, unsigned int defaultValue, int resetEachLaunch) - generic_api.h
+ * TARGET_API_REF: backendGraphConditionalCreate(backend_graph_conditional_t* cond, backend_graph_t graph, unsigned int defaultValue, unsigned int flags) - backend_api.h
+ */
+int createGraphConditional(api_graph_conditional_t* cond, api_graph_t graph,
+                           unsigned int defaultValue, int resetEachLaunch) {
+    if (cond == NULL || graph == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    unsigned int flags = resetEachLaunch ? BACKEND_GRAPH_COND_ASSIGN_DEFAULT : BACKEND_GRAPH_COND_DEFAULT;
+    backend_error_t result = backendGraphConditionalCreate((backend_graph_conditional_t*)cond,
+                                                           (backend_graph_t)graph, defaultValue, flags);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Sets a conditional value from a graph node, e.g. to end a while loop
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * SOURCE_API_REF: setGraphConditional(api_graph_conditional_t cond, unsigned int value) - generic_api.h
+ * TARGET_API_REF: backendGraphSetConditional(backend_graph_conditional_t cond, unsigned int value) - backend_api.h
+ */
+int setGraphConditional(api_graph_conditional_t cond, unsigned int value) {
+    if (cond == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphSetConditional((backend_graph_conditional_t)cond, value);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Adds an if or while node to the graph the stream is capturing, with a separately captured graph as its body
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * AI_STRATEGY: Iterative work stays inside one graph launch; the backend re-runs the body on its workers while the value is non-zero instead of the host relaunching per iteration
+ * SOURCE_API_REF: addConditionalNode(api_stream_t stream, api_graph_conditional_t cond, int type, api_graph_t body) - generic_api.h
+ * TARGET_API_REF: backendStreamAddConditionalNode(backend_stream_t stream, backend_graph_conditional_t cond, backend_graph_conditional_type type, backend_graph_t body) - backend_api.h
+ */
+int addConditionalNode(api_stream_t stream, api_graph_conditional_t cond, int type, api_graph_t body) {
+    if (stream == NULL || cond == NULL || body == NULL ||
+        (type != API_GRAPH_COND_IF && type != API_GRAPH_COND_WHILE)) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_graph_conditional_type kind = type == API_GRAPH_COND_WHILE ? BACKEND_GRAPH_COND_WHILE
+                                                                       : BACKEND_GRAPH_COND_IF;
+    backend_error_t result = backendStreamAddConditionalNode((backend_stream_t)stream,
+                                                             (backend_graph_conditional_t)cond,
+                                                             kind, (backend_graph_t)body);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Names a kernel so saved graphs can refer to it in another process
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: GRAPH_FILE_V1
+ * SOURCE_API_REF: registerKernel(void* func, const char* name) - generic_api.h
+ * TARGET_API_REF: backendRegisterKernel(const void* func, const char* name) - backend_api.h
+ */
+int registerKernel(void* func, const char* name) {
+    if (func == NULL || name == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendRegisterKernel(func, name);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Names a buffer so saved graphs store pointers into it as name plus offset
+ * AI_DEPENDENCIES: MEMORY_MANAGEMENT
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: A restarted process registers its new buffers under the same names before loading
+ * SOURCE_API_REF: registerMemory(const char* name, void* ptr, size_t size) - generic_api.h
+ * TARGET_API_REF: backendRegisterMemory(const char* name, void* base, size_t size) - backend_api.h
+ */
+int registerMemory(const char* name, void* ptr, size_t size) {
+    if (name == NULL || ptr == NULL || size == 0) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendRegisterMemory(name, ptr, size);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Writes an optimized executable graph to a file for warm starts
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Every kernel and pointer in the graph must be registered by name; callback and conditional nodes cannot be saved
+ * SOURCE_API_REF: saveGraph(api_graph_exec_t graphExec, const char* path) - generic_api.h
+ * TARGET_API_REF: backendGraphExecSave(backend_graph_exec_t exec, const char* path) - backend_api.h
+ */
+int saveGraph(api_graph_exec_t graphExec, const char* path) {
+    if (graphExec == NULL || path == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphExecSave((backend_graph_exec_t)graphExec, path);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Loads a saved executable graph, skipping capture and optimization
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Names resolve against this process's registrations; on failure the caller falls back to capturing and instantiating
+ * SOURCE_API_REF: loadGraph(api_graph_exec_t* graphExec, const char* path) - generic_api.h
+ * TARGET_API_REF: backendGraphExecLoad(backend_graph_exec_t* exec, const char* path) - backend_api.h
+ */
+int loadGraph(api_graph_exec_t* graphExec, const char* path) {
+    if (graphExec == NULL || path == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphExecLoad((backend_graph_exec_t*)graphExec, path);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys a captured graph; executable graphs made from it stay valid
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * SOURCE_API_REF: destroyGraph(api_graph_t graph) - generic_api.h
+ * TARGET_API_REF: backendGraphDestroy(backend_graph_t graph) - backend_api.h
+ */
+int destroyGraph(api_graph_t graph) {
     if (graph == NULL) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    printf("Graph instantiation not implemented yet\n");
-    return API_ERROR_NOT_IMPLEMENTED;
+    backend_error_t result = backendGraphDestroy((backend_graph_t)graph);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys an executable graph once launches already enqueued have run
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * SOURCE_API_REF: destroyGraphExec(api_graph_exec_t graphExec) - generic_api.h
+ * TARGET_API_REF: backendGraphExecDestroy(backend_graph_exec_t exec) - backend_api.h
+ */
+int destroyGraphExec(api_graph_exec_t graphExec) {
+    if (graphExec == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendGraphExecDestroy((backend_graph_exec_t)graphExec);
+    return backendErrorToApiError(result);
 }
 
 
@@ -164,7 +626,7 @@ int instantiateGraph(void* graph) {
  * AI_COMMIT: c9d8e7f
  * AI_COMMIT_HISTORY: b8c7d6e, a7b6c5d
  * AI_PATTERN: STREAM_SYNC_V2
- * AI_CHANGE: Fixed race condition in stream synchronization
+ * AI_CHANGE: Fixed race condition in stream synchronization; now waits on the backend stream
  * RUNTIME_ERR: Segmentation fault on NULL stream handle
  * FIX_REASON: Added NULL check before dereferencing stream handle
  * HUMAN_OVERRIDE: Reviewed by T. Deters on 2025-10-19
@@ -177,9 +639,8 @@ int synchronizeStream(api_stream_t stream) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Mock implementation
-    printf("Stream synchronized\n");
-    return API_SUCCESS;
+    backend_error_t result = backendStreamSynchronize((backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 
@@ -194,6 +655,7 @@ int synchronizeStream(api_stream_t stream) {
  * AI_COMMIT_HISTORY: d7e6f5a, c6d5e4f
  * AI_PATTERN: ASYNC_MEMCPY_V1
  * AI_STRATEGY: Convert API stream to backend stream, validate parameters, perform async copy
+ * AI_CHANGE: Enqueued on the backend stream, so copies are recorded while the stream captures
  * SOURCE_API_REF: copyMemoryAsync(dst, src, size, kind, stream) - generic_api.h
  * TARGET_API_REF: backendMemcpyAsync(dst, src, size, kind, stream) - backend_api.h
  */
@@ -207,34 +669,115 @@ int copyMemoryAsync(void* dst, const void* src, size_t size,
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Mock implementation
-    printf("Async memory copy: %zu bytes (kind=%d)\n", size, kind);
-    return API_SUCCESS;
+    backend_error_t result = backendMemcpyAsync(dst, src, size, (backend_memcpy_kind)kind,
+                                                (backend_stream_t)stream);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Asynchronous byte fill ordered on a stream
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING, STREAM_TRANSLATION
+ * AI_PATTERN: ASYNC_MEMSET_V1
+ * AI_STRATEGY: Same translation as copyMemoryAsync; recorded as a graph node while the stream captures
+ * SOURCE_API_REF: setMemoryAsync(dst, value, size, stream) - generic_api.h
+ * TARGET_API_REF: backendMemsetAsync(dst, value, size, stream) - backend_api.h
+ */
+int setMemoryAsync(void* dst, int value, size_t size, api_stream_t stream) {
+    if (dst == NULL || size == 0 || stream == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendMemsetAsync(dst, value, size, (backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 
-/* Example 8: Distributed agent coordination */
+/* Example 8: Peer memory access between devices */
 /*
  * AI_PHASE: PEER_MEMORY_ACCESS
- * AI_STATUS: PARTIAL
- * AI_COMPLEXITY: CRITICAL
- * AI_NOTE: Peer-to-peer memory access implementation in progress by distributed agent
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Whether device can be given direct access to peerDevice's memory
+ * AI_DEPENDENCIES: DEVICE_QUERY
+ * AI_PATTERN: PEER_QUERY_V1
+ * SOURCE_API_REF: canAccessPeer(int* canAccess, int device, int peerDevice) - generic_api.h
+ * TARGET_API_REF: backendDeviceCanAccessPeer(int* canAccessPeer, int device, int peerDevice) - backend_api.h
+ */
+int canAccessPeer(int* canAccess, int device, int peerDevice) {
+    if (canAccess == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendDeviceCanAccessPeer(canAccess, device, peerDevice);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Gives the current device direct access to peerDevice's memory
  * AI_DEPENDENCIES: DEVICE_QUERY, MEMORY_TRANSLATION
- * AI_ASSIGNED_TO: agent_memory_specialist_01
- * AI_TIMEOUT: 300
- * AI_MAX_RETRIES: 3
- * AI_CONTEXT: { "agent_session": "session_456", "retry_count": 0 }
+ * AI_PATTERN: PEER_ENABLE_V1
+ * AI_STRATEGY: Peer copies between the two devices then go arena to arena instead of staging through a bounce buffer; enabling an already enabled peer is treated as success
  * SOURCE_API_REF: enablePeerAccess(peerDevice) - generic_api.h
- * TARGET_API_REF: backendEnablePeerAccess(peerDevice) - backend_api.h
+ * TARGET_API_REF: backendDeviceEnablePeerAccess(int peerDevice, unsigned int flags) - backend_api.h
  */
 int enablePeerAccess(int peerDevice) {
     if (peerDevice < 0) {
         return API_ERROR_INVALID_VALUE;
     }
     
-    // Implementation being completed by assigned agent
-    printf("Peer access enable (IN PROGRESS)\n");
-    return API_ERROR_NOT_IMPLEMENTED;
+    backend_error_t result = backendDeviceEnablePeerAccess(peerDevice, 0);
+    if (result == BACKEND_ERROR_PEER_ACCESS_ALREADY_ENABLED) {
+        return API_SUCCESS;
+    }
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Blocking copy from srcDevice's memory to dstDevice's memory
+ * AI_DEPENDENCIES: DEVICE_QUERY, MEMORY_TRANSLATION
+ * AI_PATTERN: PEER_COPY_V1
+ * AI_STRATEGY: Both pointers must come from backendMalloc on the named devices
+ * SOURCE_API_REF: copyMemoryPeer(dst, dstDevice, src, srcDevice, size) - generic_api.h
+ * TARGET_API_REF: backendMemcpyPeer(void* dst, int dstDevice, const void* src, int srcDevice, size_t sizeBytes) - backend_api.h
+ */
+int copyMemoryPeer(void* dst, int dstDevice, const void* src, int srcDevice, size_t size) {
+    if (dst == NULL || src == NULL || size == 0) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendMemcpyPeer(dst, dstDevice, src, srcDevice, size);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Peer copy ordered on a stream of any device
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, MEMORY_TRANSLATION
+ * AI_PATTERN: PEER_COPY_ASYNC_V1
+ * AI_STRATEGY: Same translation as copyMemoryPeer; direct or staged according to peer access when it is issued
+ * SOURCE_API_REF: copyMemoryPeerAsync(dst, dstDevice, src, srcDevice, size, stream) - generic_api.h
+ * TARGET_API_REF: backendMemcpyPeerAsync(void* dst, int dstDevice, const void* src, int srcDevice, size_t sizeBytes, backend_stream_t stream) - backend_api.h
+ */
+int copyMemoryPeerAsync(void* dst, int dstDevice, const void* src, int srcDevice, size_t size,
+                        api_stream_t stream) {
+    if (dst == NULL || src == NULL || size == 0 || stream == NULL) {
+        return API_ERROR_INVALID_VALUE;
+    }
+    
+    backend_error_t result = backendMemcpyPeerAsync(dst, dstDevice, src, srcDevice, size,
+                                                    (backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 
@@ -261,6 +804,90 @@ void demonstrate_runtime_api() {
 #endif
 
 
+/* Host kernels for main: a no-op stand-in and an element-wise scale */
+static void mockKernel(const backend_kernel_context*, void**) {}
+
+static void scaleKernel(const backend_kernel_context* ctx, void** args) {
+    float* data = *(float**)args[0];
+    float factor = *(float*)args[1];
+    int count = *(int*)args[2];
+    int base = (int)(ctx->blockIdx.x * ctx->blockDim.x);
+    for (unsigned int t = 0; t < ctx->blockDim.x && base + (int)t < count; ++t) {
+        data[base + t] *= factor;
+    }
+}
+
+// Typed kernel: arguments arrive by value, nothing is boxed
+static void offsetKernel(const backend_kernel_context* ctx, float* data, float offset, int count) {
+    int base = (int)(ctx->blockIdx.x * ctx->blockDim.x);
+    for (unsigned int t = 0; t < ctx->blockDim.x && base + (int)t < count; ++t) {
+        data[base + t] += offset;
+    }
+}
+
+// Sums each block's 256 elements through a tile in shared memory
+static void blockSumKernel(const backend_kernel_context* ctx, void** args) {
+    const float* data = *(const float**)args[0];
+    float* sums = *(float**)args[1];
+    float* tile = (float*)ctx->sharedMem;
+    unsigned int width = ctx->blockDim.x;
+    for (unsigned int t = 0; t < width; ++t) {
+        tile[t] = data[ctx->blockIdx.x * width + t];
+    }
+    for (unsigned int stride = width / 2; stride > 0; stride /= 2) {
+        for (unsigned int t = 0; t < stride; ++t) {
+            tile[t] += tile[t + stride];
+        }
+    }
+    sums[ctx->blockIdx.x] = tile[0];
+}
+
+// Scales each block's slice so the whole array sums to one: block sums,
+// grid barrier, then every block divides by the total
+static void normalizeKernel(const backend_kernel_context* ctx, void** args) {
+    float* data = *(float**)args[0];
+    float* partial = *(float**)args[1];
+    unsigned int per_block = *(unsigned int*)args[2];
+    float* slice = data + ctx->blockIdx.x * per_block;
+    float sum = 0.0f;
+    for (unsigned int i = 0; i < per_block; ++i) {
+        sum += slice[i];
+    }
+    partial[ctx->blockIdx.x] = sum;
+    backendGridSync(ctx);
+    float total = 0.0f;
+    for (unsigned int b = 0; b < ctx->gridDim.x; ++b) {
+        total += partial[b];
+    }
+    for (unsigned int i = 0; i < per_block; ++i) {
+        slice[i] /= total;
+    }
+}
+
+// Persistent kernel: each block squares the items it pops until the queue closes
+static void squareWorker(const backend_kernel_context* ctx, void**) {
+    void* item;
+    while (backendWorkQueuePop(ctx->workQueue, &item) == BACKEND_SUCCESS) {
+        int* value = (int*)item;
+        *value *= *value;
+    }
+}
+
+/* Loop state for the while-node demo in main */
+struct CountdownLoop {
+    api_graph_conditional_t cond;
+    int remaining;
+    int iterations;
+};
+
+static void countdownStep(backend_stream_t, backend_error_t, void* userData) {
+    CountdownLoop* loop = (CountdownLoop*)userData;
+    loop->iterations++;
+    if (--loop->remaining == 0) {
+        setGraphConditional(loop->cond, 0);
+    }
+}
+
 /* Main function demonstrating usage */
 int main() {
     printf("ACD Metadata Header Example\n");
@@ -276,32 +903,276 @@ int main() {
     result = getDeviceProperties(0);
     printf("Get device properties result: %d\n", result);
     
+    // This example has no stream API of its own; take one from the backend
+    api_stream_t stream = NULL;
+    if (backendStreamCreate((backend_stream_t*)&stream, 0) != BACKEND_SUCCESS) {
+        return 1;
+    }
+    
     // Test kernel launch
     void* mock_func = (void*)0x1000;
-    result = launchKernel(mock_func, 1, 1, 1, 256, 1, 1, NULL, 0, NULL);
+    registerHostKernel(mock_func, mockKernel);
+    result = launchKernel(mock_func, 1, 1, 1, 256, 1, 1, NULL, 0, stream);
     printf("Launch kernel result: %d\n", result);
     
-    // Test stream synchronization
-    api_stream_t mock_stream = (api_stream_t)0x2000;
-    result = synchronizeStream(mock_stream);
-    printf("Synchronize stream result: %d\n", result);
+    // A real kernel: 64 blocks of 256 elements, spread over the host workers
+    static float values[64 * 256];
+    for (int i = 0; i < 64 * 256; ++i) {
+        values[i] = (float)i;
+    }
+    float* values_ptr = values;
+    float factor = 2.0f;
+    int value_count = 64 * 256;
+    void* scale_args[] = { &values_ptr, &factor, &value_count };
+    registerHostKernel((void*)scaleKernel, scaleKernel);
+    int scale_grid = 64, scale_block = 256;
+    suggestLaunchConfig((void*)scaleKernel, 0, (size_t)value_count, &scale_grid, &scale_block);
+    result = launchKernel((void*)scaleKernel, scale_grid, 1, 1, scale_block, 1, 1, scale_args, 0, stream);
+    synchronizeStream(stream);
+    printf("Host kernel result: %d (values[1000]=%.0f, %d blocks of %d)\n", result, values[1000],
+           scale_grid, scale_block);
+    
+    // The same shape of launch with typed arguments, which need not outlive the call
+    backend_dim3 offset_grid = { 64, 1, 1 };
+    backend_dim3 offset_block = { 256, 1, 1 };
+    backendLaunch(offsetKernel, offset_grid, offset_block, 0, (backend_stream_t)stream,
+                  values_ptr, 1.0f, value_count);
+    backendLaunch(offsetKernel, offset_grid, offset_block, 0, (backend_stream_t)stream,
+                  values_ptr, -1.0f, value_count);
+    synchronizeStream(stream);
+    printf("Typed launch result: values[1000]=%.0f\n", values[1000]);
+    
+    // Block sums staged in a 1 KiB shared-memory tile per block
+    static float sums[64];
+    float* sums_ptr = sums;
+    void* sum_args[] = { &values_ptr, &sums_ptr };
+    registerHostKernel((void*)blockSumKernel, blockSumKernel);
+    setKernelSharedMemory((void*)blockSumKernel, 256 * sizeof(float));
+    result = launchKernel((void*)blockSumKernel, 64, 1, 1, 256, 1, 1, sum_args, 0, stream);
+    synchronizeStream(stream);
+    printf("Shared memory kernel result: %d (sums[1]=%.0f)\n", result, sums[1]);
+    int resident = 0;
+    occupancyMaxActiveBlocks(&resident, (void*)blockSumKernel, 256, 0);
+    printf("Shared memory kernel occupancy: %d blocks at once\n", resident);
+    
+    // Reduce and normalize in one cooperative launch, one block per worker
+    unsigned int coop_blocks = 0;
+    backendGetCooperativeGridLimit(&coop_blocks);
+    unsigned int per_block = 64;
+    unsigned int weight_count = coop_blocks * per_block;
+    float* weights_ptr = (float*)malloc(weight_count * sizeof(float));
+    float* partials_ptr = (float*)malloc(coop_blocks * sizeof(float));
+    for (unsigned int i = 0; i < weight_count; ++i) {
+        weights_ptr[i] = 1.0f;
+    }
+    void* norm_args[] = { &weights_ptr, &partials_ptr, &per_block };
+    registerHostKernel((void*)normalizeKernel, normalizeKernel);
+    result = launchCooperativeKernel((void*)normalizeKernel, (int)coop_blocks, 64, norm_args, 0, stream);
+    synchronizeStream(stream);
+    printf("Cooperative kernel result: %d (weights sum to %.2f)\n", result,
+           weights_ptr[0] * (float)weight_count);
+    free(weights_ptr);
+    free(partials_ptr);
+    
+    // Sixteen one-block scale kernels queued as a single operation
+    static float steps[256];
+    for (int i = 0; i < 256; ++i) {
+        steps[i] = 1.0f;
+    }
+    float* steps_ptr = steps;
+    int step_count = 256;
+    void* step_args[] = { &steps_ptr, &factor, &step_count };
+    backend_launch_params batch[16];
+    for (int i = 0; i < 16; ++i) {
+        batch[i].func = (void*)scaleKernel;
+        batch[i].grid.x = batch[i].grid.y = batch[i].grid.z = 1;
+        batch[i].block.x = 256;
+        batch[i].block.y = batch[i].block.z = 1;
+        batch[i].args = step_args;
+        batch[i].sharedMem = 0;
+    }
+    result = launchKernelBatch(batch, 16, stream);
+    synchronizeStream(stream);
+    printf("Kernel batch result: %d (steps[0]=%.0f)\n", result, steps[0]);
+    
+    // One persistent launch of up to four workers, then work items pushed to it
+    static int squares[100];
+    backend_work_queue_t work = NULL;
+    backendWorkQueueCreate(&work, 128);     // room for every item, so no push is refused
+    registerHostKernel((void*)squareWorker, squareWorker);
+    unsigned int square_workers = coop_blocks < 4 ? coop_blocks : 4;
+    result = backendErrorToApiError(backendLaunchPersistentKernel((void*)squareWorker, square_workers,
+                                                                  work, NULL, (backend_stream_t)stream));
+    for (int i = 0; i < 100; ++i) {
+        squares[i] = i;
+        pushWork(work, &squares[i]);
+    }
+    backendWorkQueueClose(work);
+    synchronizeStream(stream);
+    backendWorkQueueDestroy(work);
+    printf("Persistent kernel result: %d (squares[99]=%d)\n", result, squares[99]);
+    
+    // As many single-worker persistent kernels as there are workers, each
+    // on its own stream; they wait on the cooperative pool, so a fill on
+    // another stream still runs while every one of them is resident
+    api_stream_t* servers = (api_stream_t*)calloc(coop_blocks, sizeof(api_stream_t));
+    backend_work_queue_t* server_queues = (backend_work_queue_t*)calloc(coop_blocks, sizeof(backend_work_queue_t));
+    for (unsigned int i = 0; i < coop_blocks; ++i) {
+        backendStreamCreate((backend_stream_t*)&servers[i], 0);
+        backendWorkQueueCreate(&server_queues[i], 4);
+        backendLaunchPersistentKernel((void*)squareWorker, 1, server_queues[i], NULL,
+                                      (backend_stream_t)servers[i]);
+    }
+    unsigned char marker[64];
+    memset(marker, 0, sizeof(marker));
+    result = setMemoryAsync(marker, 9, sizeof(marker), stream);
+    synchronizeStream(stream);
+    for (unsigned int i = 0; i < coop_blocks; ++i) {
+        backendWorkQueueClose(server_queues[i]);
+        synchronizeStream(servers[i]);
+        backendWorkQueueDestroy(server_queues[i]);
+        backendStreamDestroy((backend_stream_t)servers[i]);
+    }
+    free(server_queues);
+    free(servers);
+    printf("Fill beside %u persistent kernels: %d (marker[63]=%d)\n", coop_blocks, result, marker[63]);
+    
+    // One fill per device, each on a stream and buffer of that device;
+    // run with BACKEND_DEVICES=4 (or numa, l3) to split the host
+    for (int device = 0; device < device_count; ++device) {
+        setDevice(device);
+        api_stream_t device_stream = NULL;
+        unsigned char* device_buffer = NULL;
+        backendStreamCreate((backend_stream_t*)&device_stream, 0);
+        backendMalloc((void**)&device_buffer, 4096);
+        backendMemsetAsync(device_buffer, device + 1, 4096, (backend_stream_t)device_stream);
+        synchronizeStream(device_stream);
+        int current = -1;
+        getDevice(&current);
+        printf("Device %d fill: buffer[0]=%d\n", current, device_buffer[0]);
+        backendFree(device_buffer);
+        backendStreamDestroy((backend_stream_t)device_stream);
+    }
+    setDevice(0);
     
     // Test memory operations
     char src[100], dst[100];
-    result = copyMemoryAsync(dst, src, 100, 1, mock_stream);
+    memset(src, 7, sizeof(src));
+    result = copyMemoryAsync(dst, src, 100, 1, stream);
     printf("Async memory copy result: %d\n", result);
     
-    // Test partial implementations
-    printf("\nTesting partial/not-started implementations:\n");
-    void* graph = NULL;
-    result = captureGraphBegin(&graph, mock_stream);
+    // Test stream synchronization
+    result = synchronizeStream(stream);
+    printf("Synchronize stream result: %d\n", result);
+    
+    // Capture a fill-copy-kernel sequence once, then replay it
+    printf("\nTesting graph capture:\n");
+    api_graph_t graph = NULL;
+    result = captureGraphBegin(&graph, stream);
     printf("Capture graph result: %d\n", result);
     
-    result = instantiateGraph(graph);
+    setMemoryAsync(src, 1, sizeof(src), stream);
+    copyMemoryAsync(dst, src, sizeof(src), 1, stream);
+    launchKernel(mock_func, 1, 1, 1, 256, 1, 1, NULL, 0, stream);
+    result = endCapture(stream, &graph);
+    printf("End capture result: %d\n", result);
+    
+    api_graph_exec_t graph_exec = NULL;
+    result = instantiateGraph(&graph_exec, graph);
     printf("Instantiate graph result: %d\n", result);
     
-    result = enablePeerAccess(1);
-    printf("Enable peer access result: %d\n", result);
+    for (int i = 0; i < 3; ++i) {
+        result = launchGraph(graph_exec, stream);
+    }
+    synchronizeStream(stream);
+    printf("Launch graph result: %d (dst[0]=%d)\n", result, dst[0]);
+    
+    // Same sequence with a different fill value: patch instead of re-instantiating
+    api_graph_t next_graph = NULL;
+    captureGraphBegin(&next_graph, stream);
+    setMemoryAsync(src, 2, sizeof(src), stream);
+    copyMemoryAsync(dst, src, sizeof(src), 1, stream);
+    launchKernel(mock_func, 1, 1, 1, 256, 1, 1, NULL, 0, stream);
+    endCapture(stream, &next_graph);
+    result = graphExecUpdate(graph_exec, next_graph);
+    launchGraph(graph_exec, stream);
+    synchronizeStream(stream);
+    printf("Graph exec update result: %d (dst[0]=%d)\n", result, dst[0]);
+    
+    // Save the optimized graph and load it back as a restarted process would
+    registerKernel(mock_func, "mock_kernel");
+    registerMemory("src", src, sizeof(src));
+    registerMemory("dst", dst, sizeof(dst));
+    result = saveGraph(graph_exec, "header_example.graph");
+    printf("Save graph result: %d\n", result);
+    api_graph_exec_t loaded_exec = NULL;
+    memset(dst, 0, sizeof(dst));
+    result = loadGraph(&loaded_exec, "header_example.graph");
+    launchGraph(loaded_exec, stream);
+    synchronizeStream(stream);
+    printf("Load graph result: %d (dst[0]=%d)\n", result, dst[0]);
+    destroyGraphExec(loaded_exec);
+    remove("header_example.graph");
+    
+    destroyGraphExec(graph_exec);
+    destroyGraph(next_graph);
+    destroyGraph(graph);
+    
+    // A while node: the body runs until its own callback clears the value,
+    // all inside one launch. This example has no callback API of its own.
+    printf("\nTesting conditional graph nodes:\n");
+    api_stream_t body_stream = NULL;
+    backendStreamCreate((backend_stream_t*)&body_stream, 0);
+    CountdownLoop loop = { NULL, 4, 0 };
+    api_graph_t loop_graph = NULL;
+    api_graph_t body_graph = NULL;
+    captureGraphBegin(&loop_graph, stream);
+    createGraphConditional(&loop.cond, loop_graph, 1, 0);
+    captureGraphBegin(&body_graph, body_stream);
+    copyMemoryAsync(dst, src, sizeof(src), 1, body_stream);
+    backendStreamAddCallback((backend_stream_t)body_stream, countdownStep, &loop);
+    endCapture(body_stream, &body_graph);
+    result = addConditionalNode(stream, loop.cond, API_GRAPH_COND_WHILE, body_graph);
+    printf("Add while node result: %d\n", result);
+    endCapture(stream, &loop_graph);
+    
+    api_graph_exec_t loop_exec = NULL;
+    instantiateGraph(&loop_exec, loop_graph);
+    result = launchGraph(loop_exec, stream);
+    synchronizeStream(stream);
+    printf("Launch loop graph result: %d (iterations=%d)\n", result, loop.iterations);
+    
+    destroyGraphExec(loop_exec);
+    destroyGraph(body_graph);
+    destroyGraph(loop_graph);
+    backendStreamDestroy((backend_stream_t)body_stream);
+    backendStreamDestroy((backend_stream_t)stream);
+    
+    // Peer copy from the last device to device 0; with one device there
+    // is no peer and enabling access fails with INVALID_VALUE
+    printf("\nTesting peer access:\n");
+    int peer = device_count - 1;
+    int can_access = 0;
+    canAccessPeer(&can_access, 0, peer);
+    result = enablePeerAccess(peer);
+    printf("Enable peer access result: %d (can access device %d: %d)\n", result, peer, can_access);
+    if (can_access) {
+        api_stream_t peer_stream = NULL;
+        unsigned char* local = NULL;
+        unsigned char* remote = NULL;
+        backendStreamCreate((backend_stream_t*)&peer_stream, 0);
+        backendMalloc((void**)&local, 4096);
+        setDevice(peer);
+        backendMalloc((void**)&remote, 4096);
+        setDevice(0);
+        memset(remote, 9, 4096);
+        result = copyMemoryPeerAsync(local, 0, remote, peer, 4096, peer_stream);
+        synchronizeStream(peer_stream);
+        printf("Peer copy result: %d (local[0]=%d)\n", result, local[0]);
+        backendFree(remote);
+        backendFree(local);
+        backendStreamDestroy((backend_stream_t)peer_stream);
+    }
     
 #ifdef ACD_ENABLE_RUNTIME_API
     demonstrate_runtime_api();
@@ -113,12 +113,12 @@ api_error_t freeMemory(void* devPtr) {
  * AI_PATTERN: UNIFIED_MEMORY_V1
  * AI_STRATEGY: Use backend managed memory with fallback to device allocation
  * SOURCE_API_REF: allocateManagedMemory(void** ptr, size_t size, unsigned int flags) - generic_api.h
- * TARGET_API_REF: backendAllocateManaged(void** dev_ptr, size_t size, unsigned int flags) - backend_api.h
+ * TARGET_API_REF: backendMallocManaged(void** ptr, size_t sizeBytes, unsigned int flags) - backend_api.h
  */
 api_error_t allocateManagedMemory(void** devPtr, size_t size, unsigned int flags) {
     // Mock implementation
     // Check if unified memory is supported
-    // backend_error_t backend_result = backendAllocateManaged(devPtr, size, flags);
+    // backend_error_t backend_result = backendMallocManaged(devPtr, size, flags);
     // if (backend_result != BACKEND_SUCCESS) {
     //     // Fallback to device allocation
     //     backend_result = backendAllocate(devPtr, size);
@@ -29,6 +29,7 @@
  * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
  */
 
+#include "../src/backend_api.h"
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -49,14 +50,41 @@ enum api_event_flags {
     API_EVENT_DISABLE_TIMING = 2
 };
 
-// Backend API types
-typedef int backend_error_t;
-typedef void* backend_stream_t;
-typedef void* backend_event_t;
+enum api_wait_policy {
+    API_WAIT_DEFAULT = 0,
+    API_WAIT_SPIN = 1,
+    API_WAIT_YIELD = 2,
+    API_WAIT_BLOCK = 3,
+    API_WAIT_ADAPTIVE = 4
+};
+
+struct api_wait_stats {
+    uint64_t spin_ns;
+    uint64_t spin_waits;
+    uint64_t yield_ns;
+    uint64_t yield_waits;
+    uint64_t block_ns;
+    uint64_t block_waits;
+};
 
 // Error values
 const api_error_t API_SUCCESS = 0;
-const backend_error_t BACKEND_SUCCESS = 0;
+const api_error_t API_ERROR_FAILED = -1;        // details from getLastError
+const api_error_t API_ERROR_NOT_READY = -2;
+
+// Backend code of the calling thread's most recent failure
+static thread_local backend_error_t last_error = BACKEND_SUCCESS;
+
+static api_error_t backendErrorToApiError(backend_error_t result) {
+    if (result == BACKEND_SUCCESS) {
+        return API_SUCCESS;
+    }
+    if (result == BACKEND_ERROR_NOT_READY) {
+        return API_ERROR_NOT_READY;
+    }
+    last_error = result;
+    return API_ERROR_FAILED;
+}
 
 /*
  * AI_PHASE: STREAM_TRANSLATION
@@ -72,9 +100,8 @@ const backend_error_t BACKEND_SUCCESS = 0;
  * TARGET_API_REF: backendStreamCreate(backend_stream_t* stream, unsigned int flags) - backend_api.h
  */
 api_error_t createStream(api_stream_t* stream, unsigned int flags) {
-    // Mock implementation
     if (stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
     // Translate flags
@@ -83,9 +110,8 @@ api_error_t createStream(api_stream_t* stream, unsigned int flags) {
         backend_flags |= 1; // Backend non-blocking flag
     }
     
-    // Mock: backend_error_t result = backendStreamCreate((backend_stream_t*)stream, backend_flags);
-    *stream = malloc(64); // Mock allocation
-    return *stream != nullptr ? API_SUCCESS : -1;
+    backend_error_t result = backendStreamCreate((backend_stream_t*)stream, backend_flags);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -101,33 +127,33 @@ api_error_t createStream(api_stream_t* stream, unsigned int flags) {
  */
 api_error_t destroyStream(api_stream_t stream) {
     if (stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendStreamDestroy((backend_stream_t)stream);
-    free(stream); // Mock deallocation
-    return API_SUCCESS;
+    backend_error_t result = backendStreamDestroy((backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 /*
  * AI_PHASE: STREAM_TRANSLATION
  * AI_STATUS: IMPLEMENTED
  * AI_COMPLEXITY: MEDIUM
- * AI_NOTE: Blocks until stream completes all operations
+ * AI_NOTE: Blocks until stream completes all operations; fails if work on the stream raised an async error
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING, DEVICE_QUERY
  * AI_COMMIT: c7d6e5f
  * AI_COMMIT_HISTORY: b8c7d6e, a9b8c7d
  * AI_PATTERN: STREAM_SYNC_V1
+ * AI_STRATEGY: Host waits under the stream's wait policy (adaptive spin-then-block by default)
  * SOURCE_API_REF: synchronizeStream(api_stream_t stream) - generic_api.h
  * TARGET_API_REF: backendStreamSynchronize(backend_stream_t stream) - backend_api.h
  */
 api_error_t synchronizeStream(api_stream_t stream) {
     if (stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendStreamSynchronize((backend_stream_t)stream);
-    return API_SUCCESS;
+    backend_error_t result = backendStreamSynchronize((backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -138,17 +164,20 @@ api_error_t synchronizeStream(api_stream_t stream) {
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
  * AI_COMMIT: d6e5f4a
  * AI_COMMIT_HISTORY: c7d6e5f, b8c7d6e
+ * AI_STRATEGY: Loads of the stream's error and status words, one cache line; safe to poll from a hot loop. Reports an async error as soon as it is raised, without waiting for the stream
+ * AI_CHANGE: Still-running is API_ERROR_NOT_READY, no longer the -1 that now only means failure
  * SOURCE_API_REF: queryStream(api_stream_t stream) - generic_api.h
  * TARGET_API_REF: backendStreamQuery(backend_stream_t stream) - backend_api.h
  */
 api_error_t queryStream(api_stream_t stream) {
     if (stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendStreamQuery((backend_stream_t)stream);
-    // Return 0 for complete, -1 for still running
-    return API_SUCCESS;
+    // 0 when complete, API_ERROR_NOT_READY while running, API_ERROR_FAILED
+    // once an async error has been raised on the stream
+    backend_error_t result = backendStreamQuery((backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -159,8 +188,9 @@ api_error_t queryStream(api_stream_t stream) {
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING, EVENT_MANAGEMENT
  * AI_COMMIT: e5f4a3b
  * AI_COMMIT_HISTORY: d6e5f4a, c7d6e5f
- * AI_PATTERN: STREAM_CALLBACK_V1
- * AI_STRATEGY: Register callback to be invoked when stream operations complete
+ * AI_PATTERN: STREAM_CALLBACK_V2
+ * AI_STRATEGY: Callback runs in stream order on the backend's dispatcher pool, separate from copy/kernel workers; consecutive callbacks are batched into one dispatch
+ * AI_CHANGE: Callbacks were validated and dropped; now enqueued with backendStreamAddCallback
  * SOURCE_API_REF: addStreamCallback(api_stream_t stream, callback_t callback, void* userData) - generic_api.h
  * TARGET_API_REF: backendStreamAddCallback(backend_stream_t stream, callback_t callback, void* userData) - backend_api.h
  */
@@ -168,11 +198,11 @@ typedef void (*callback_t)(api_stream_t stream, api_error_t status, void* userDa
 
 api_error_t addStreamCallback(api_stream_t stream, callback_t callback, void* userData) {
     if (stream == nullptr || callback == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendStreamAddCallback((backend_stream_t)stream, callback, userData);
-    return API_SUCCESS;
+    backend_error_t result = backendStreamAddCallback((backend_stream_t)stream, callback, userData);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -190,21 +220,20 @@ api_error_t addStreamCallback(api_stream_t stream, callback_t callback, void* us
  */
 api_error_t createEvent(api_event_t* event, unsigned int flags) {
     if (event == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
     // Translate flags
     unsigned int backend_flags = 0;
     if (flags & API_EVENT_BLOCKING_SYNC) {
-        backend_flags |= 1; // Backend blocking sync flag
+        backend_flags |= BACKEND_EVENT_BLOCKING_SYNC; // Sleeps in synchronizeEvent
     }
     if (flags & API_EVENT_DISABLE_TIMING) {
-        backend_flags |= 2; // Backend disable timing flag
+        backend_flags |= BACKEND_EVENT_DISABLE_TIMING;
     }
     
-    // Mock: backend_error_t result = backendEventCreate((backend_event_t*)event, backend_flags);
-    *event = malloc(32); // Mock allocation
-    return *event != nullptr ? API_SUCCESS : -1;
+    backend_error_t result = backendEventCreate((backend_event_t*)event, backend_flags);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -220,12 +249,11 @@ api_error_t createEvent(api_event_t* event, unsigned int flags) {
  */
 api_error_t destroyEvent(api_event_t event) {
     if (event == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendEventDestroy((backend_event_t)event);
-    free(event); // Mock deallocation
-    return API_SUCCESS;
+    backend_error_t result = backendEventDestroy((backend_event_t)event);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -242,11 +270,11 @@ api_error_t destroyEvent(api_event_t event) {
  */
 api_error_t recordEvent(api_event_t event, api_stream_t stream) {
     if (event == nullptr || stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendEventRecord((backend_event_t)event, (backend_stream_t)stream);
-    return API_SUCCESS;
+    backend_error_t result = backendEventRecord((backend_event_t)event, (backend_stream_t)stream);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -257,16 +285,17 @@ api_error_t recordEvent(api_event_t event, api_stream_t stream) {
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
  * AI_COMMIT: c1d0e9f
  * AI_COMMIT_HISTORY: b2c1d0e, a3b2c1d
+ * AI_STRATEGY: API_EVENT_BLOCKING_SYNC events sleep on a futex; others use the event or process wait policy
  * SOURCE_API_REF: synchronizeEvent(api_event_t event) - generic_api.h
  * TARGET_API_REF: backendEventSynchronize(backend_event_t event) - backend_api.h
  */
 api_error_t synchronizeEvent(api_event_t event) {
     if (event == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendEventSynchronize((backend_event_t)event);
-    return API_SUCCESS;
+    backend_error_t result = backendEventSynchronize((backend_event_t)event);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -277,16 +306,43 @@ api_error_t synchronizeEvent(api_event_t event) {
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
  * AI_COMMIT: d0e9f8a
  * AI_COMMIT_HISTORY: c1d0e9f, b2c1d0e
+ * AI_STRATEGY: Single acquire load of the event's status word; safe to poll from a hot loop
+ * AI_CHANGE: Backend query no longer takes the event lock
  * SOURCE_API_REF: queryEvent(api_event_t event) - generic_api.h
  * TARGET_API_REF: backendEventQuery(backend_event_t event) - backend_api.h
  */
 api_error_t queryEvent(api_event_t event) {
     if (event == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendEventQuery((backend_event_t)event);
-    return API_SUCCESS;
+    backend_error_t result = backendEventQuery((backend_event_t)event);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Polls a batch of events; results[i] is 0 if events[i] has occurred, API_ERROR_NOT_READY if not yet, API_ERROR_FAILED for an invalid handle
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_PATTERN: EVENT_QUERY_BATCH_V1
+ * AI_STRATEGY: One backend call per batch; returns 0 only when every event has occurred
+ * SOURCE_API_REF: queryEvents(api_event_t* events, size_t count, api_error_t* results) - generic_api.h
+ * TARGET_API_REF: backendEventQueryBatch(const backend_event_t* events, size_t count, backend_error_t* results) - backend_api.h
+ */
+api_error_t queryEvents(api_event_t* events, size_t count, api_error_t* results) {
+    if (count > 0 && (events == nullptr || results == nullptr)) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    // api_event_t and backend_event_t are both opaque handles
+    backend_error_t result = backendEventQueryBatch((const backend_event_t*)events, count,
+                                                    (backend_error_t*)results);
+    for (size_t i = 0; i < count; ++i) {
+        results[i] = backendErrorToApiError((backend_error_t)results[i]);
+    }
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -304,7 +360,7 @@ api_error_t queryEvent(api_event_t event) {
  */
 api_error_t elapsedTime(float* ms, api_event_t start, api_event_t end) {
     if (ms == nullptr || start == nullptr || end == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
     // Mock: backend_error_t result = backendEventElapsedTime(ms, (backend_event_t)start, (backend_event_t)end);
@@ -316,22 +372,101 @@ api_error_t elapsedTime(float* ms, api_event_t start, api_event_t end) {
  * AI_PHASE: STREAM_TRANSLATION
  * AI_STATUS: IMPLEMENTED
  * AI_COMPLEXITY: HIGH
- * AI_NOTE: Makes stream wait on an event before proceeding
+ * AI_NOTE: Makes stream wait on an event before proceeding, without blocking any host thread
  * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING, STREAM_TRANSLATION, EVENT_MANAGEMENT
  * AI_COMMIT: f8a7b6c
  * AI_COMMIT_HISTORY: e9f8a7b, d0e9f8a
- * AI_PATTERN: STREAM_WAIT_EVENT_V1
- * AI_STRATEGY: Ensures proper ordering between streams using event synchronization
+ * AI_PATTERN: STREAM_WAIT_EVENT_V2
+ * AI_STRATEGY: Device-side dependency - the backend parks the stream head on the event and the completing worker reschedules it
+ * AI_CHANGE: Replaced mock with backendStreamWaitEvent; no host sync point between streams
  * SOURCE_API_REF: streamWaitEvent(api_stream_t stream, api_event_t event) - generic_api.h
  * TARGET_API_REF: backendStreamWaitEvent(backend_stream_t stream, backend_event_t event) - backend_api.h
  */
 api_error_t streamWaitEvent(api_stream_t stream, api_event_t event) {
     if (stream == nullptr || event == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // Mock: backend_error_t result = backendStreamWaitEvent((backend_stream_t)stream, (backend_event_t)event);
-    return API_SUCCESS;
+    backend_error_t result = backendStreamWaitEvent((backend_stream_t)stream, (backend_event_t)event);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Writes a 32-bit value to memory once the stream reaches this point
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * AI_STRATEGY: Counter signalling without an event - the writing worker reschedules any stream waiting on the word
+ * SOURCE_API_REF: streamWriteValue32(api_stream_t stream, uint32_t* addr, uint32_t value, unsigned int flags) - generic_api.h
+ * TARGET_API_REF: backendStreamWriteValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value, unsigned int flags) - backend_api.h
+ */
+api_error_t streamWriteValue32(api_stream_t stream, uint32_t* addr, uint32_t value, unsigned int flags) {
+    if (stream == nullptr || addr == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendStreamWriteValue32((backend_stream_t)stream, addr, value, flags);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: 64-bit form of streamWriteValue32
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * SOURCE_API_REF: streamWriteValue64(api_stream_t stream, uint64_t* addr, uint64_t value, unsigned int flags) - generic_api.h
+ * TARGET_API_REF: backendStreamWriteValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value, unsigned int flags) - backend_api.h
+ */
+api_error_t streamWriteValue64(api_stream_t stream, uint64_t* addr, uint64_t value, unsigned int flags) {
+    if (stream == nullptr || addr == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendStreamWriteValue64((backend_stream_t)stream, addr, value, flags);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Holds the stream until a 32-bit word is >=, == or & value (flags selects which)
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * AI_STRATEGY: The backend parks the stream head on the word; no host thread or worker polls it. The word must be written with streamWriteValue32/64 (or the writer must call backendNotifyValue)
+ * SOURCE_API_REF: streamWaitValue32(api_stream_t stream, uint32_t* addr, uint32_t value, unsigned int flags) - generic_api.h
+ * TARGET_API_REF: backendStreamWaitValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value, unsigned int flags) - backend_api.h
+ */
+api_error_t streamWaitValue32(api_stream_t stream, uint32_t* addr, uint32_t value, unsigned int flags) {
+    if (stream == nullptr || addr == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendStreamWaitValue32((backend_stream_t)stream, addr, value, flags);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: 64-bit form of streamWaitValue32
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * SOURCE_API_REF: streamWaitValue64(api_stream_t stream, uint64_t* addr, uint64_t value, unsigned int flags) - generic_api.h
+ * TARGET_API_REF: backendStreamWaitValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value, unsigned int flags) - backend_api.h
+ */
+api_error_t streamWaitValue64(api_stream_t stream, uint64_t* addr, uint64_t value, unsigned int flags) {
+    if (stream == nullptr || addr == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendStreamWaitValue64((backend_stream_t)stream, addr, value, flags);
+    return backendErrorToApiError(result);
 }
 
 /*
@@ -348,7 +483,7 @@ api_error_t streamWaitEvent(api_stream_t stream, api_event_t event) {
  */
 api_error_t setStreamPriority(api_stream_t stream, int priority) {
     if (stream == nullptr) {
-        return -1;
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
     // TODO: Verify backend support for stream priorities
@@ -360,20 +495,143 @@ api_error_t setStreamPriority(api_stream_t stream, int priority) {
 
 /*
  * AI_PHASE: STREAM_TRANSLATION
- * AI_STATUS: NOT_STARTED
+ * AI_STATUS: IMPLEMENTED
  * AI_COMPLEXITY: HIGH
- * AI_NOTE: Placeholder for stream memory operations - requires design review
+ * AI_NOTE: Attaches managed memory to one stream, in stream order; only that stream should touch it, and the host once the stream has synchronized
  * AI_DEPENDENCIES: STREAM_TRANSLATION, MEMORY_TRANSLATION
+ * AI_PATTERN: UNIFIED_MEMORY_V1
+ * AI_STRATEGY: Single attachment: the backend moves the pages to the stream's device node and faults them in on its worker before the stream's next op, instead of keeping them interleaved for every device
+ * AI_CHANGE: Was a NOT_STARTED placeholder returning -2
  * SOURCE_API_REF: streamAttachMemAsync(api_stream_t stream, void* devPtr, size_t length) - generic_api.h
- * TARGET_API_REF: backendStreamAttachMemAsync(backend_stream_t stream, void* devPtr, size_t length) - backend_api.h
+ * TARGET_API_REF: backendStreamAttachMemAsync(backend_stream_t stream, void* ptr, size_t length, unsigned int flags) - backend_api.h
  */
 api_error_t streamAttachMemAsync(api_stream_t stream, void* devPtr, size_t length) {
-    if (stream == nullptr || devPtr == nullptr || length == 0) {
-        return -1;
+    if (stream == nullptr || devPtr == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
     }
     
-    // TODO: Implement stream memory attachment
-    return -2; // Not implemented
+    backend_error_t result = backendStreamAttachMemAsync((backend_stream_t)stream, devPtr, length,
+                                                         BACKEND_MEM_ATTACH_SINGLE);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Selects the process-wide host wait policy for synchronizeStream/synchronizeEvent
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_PATTERN: WAIT_POLICY_V1
+ * SOURCE_API_REF: setWaitPolicy(api_wait_policy policy) - generic_api.h
+ * TARGET_API_REF: backendSetWaitPolicy(backend_wait_policy policy) - backend_api.h
+ */
+api_error_t setWaitPolicy(api_wait_policy policy) {
+    backend_error_t result = backendSetWaitPolicy((backend_wait_policy)policy);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Overrides the host wait policy used when synchronizing one stream
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_PATTERN: WAIT_POLICY_V1
+ * SOURCE_API_REF: setStreamWaitPolicy(api_stream_t stream, api_wait_policy policy) - generic_api.h
+ * TARGET_API_REF: backendStreamSetWaitPolicy(backend_stream_t stream, backend_wait_policy policy) - backend_api.h
+ */
+api_error_t setStreamWaitPolicy(api_stream_t stream, api_wait_policy policy) {
+    if (stream == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendStreamSetWaitPolicy((backend_stream_t)stream, (backend_wait_policy)policy);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Overrides the host wait policy used when synchronizing one event
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_PATTERN: WAIT_POLICY_V1
+ * SOURCE_API_REF: setEventWaitPolicy(api_event_t event, api_wait_policy policy) - generic_api.h
+ * TARGET_API_REF: backendEventSetWaitPolicy(backend_event_t event, backend_wait_policy policy) - backend_api.h
+ */
+api_error_t setEventWaitPolicy(api_event_t event, api_wait_policy policy) {
+    if (event == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_error_t result = backendEventSetWaitPolicy((backend_event_t)event, (backend_wait_policy)policy);
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports host time spent waiting in spin, yield and block modes
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * SOURCE_API_REF: getWaitStats(api_wait_stats* stats, int reset) - generic_api.h
+ * TARGET_API_REF: backendGetWaitStats(backend_wait_stats* stats, int reset) - backend_api.h
+ */
+api_error_t getWaitStats(api_wait_stats* stats, int reset) {
+    if (stats == nullptr) {
+        return backendErrorToApiError(BACKEND_ERROR_INVALID_VALUE);
+    }
+    
+    backend_wait_stats backend_stats;
+    backend_error_t result = backendGetWaitStats(&backend_stats, reset);
+    stats->spin_ns = backend_stats.spin_ns;
+    stats->spin_waits = backend_stats.spin_waits;
+    stats->yield_ns = backend_stats.yield_ns;
+    stats->yield_waits = backend_stats.yield_waits;
+    stats->block_ns = backend_stats.block_ns;
+    stats->block_waits = backend_stats.block_waits;
+    return backendErrorToApiError(result);
+}
+
+/*
+ * AI_PHASE: ERROR_HANDLING
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Returns the backend error code behind this thread's last failed call and resets it to success
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_PATTERN: LAST_ERROR_V1
+ * AI_STRATEGY: Thread-local slot written by the error translation of every call here, so a failure on one thread is never reported on another. Async errors land in it when synchronizeStream or queryStream reports them
+ * SOURCE_API_REF: getLastError() - generic_api.h
+ */
+backend_error_t getLastError() {
+    backend_error_t error = last_error;
+    last_error = BACKEND_SUCCESS;
+    return error;
+}
+
+/*
+ * AI_PHASE: ERROR_HANDLING
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Like getLastError, but leaves the slot as it is
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_PATTERN: LAST_ERROR_V1
+ * SOURCE_API_REF: peekAtLastError() - generic_api.h
+ */
+backend_error_t peekAtLastError() {
+    return last_error;
+}
+
+static void onStreamDone(api_stream_t stream, api_error_t status, void* userData) {
+    (void)stream;
+    *static_cast<api_error_t*>(userData) = status;
+}
+
+// A host kernel that finds its input bad and fails the launch
+static void checkedKernel(const backend_kernel_context* ctx, const float* input) {
+    if (input == nullptr) {
+        backendKernelRaiseError(ctx, BACKEND_ERROR_LAUNCH_FAILURE);
+    }
 }
 
 // Example main function demonstrating usage
@@ -407,9 +665,56 @@ int main() {
     // ... do some work ...
     result = recordEvent(event_end, stream);
     
+    // Runs on a callback dispatcher once the events above have completed
+    api_error_t callback_status = -1;
+    result = addStreamCallback(stream, onStreamDone, &callback_status);
+    
+    // Order a second stream after the first without a host sync point
+    api_stream_t consumer = nullptr;
+    result = createStream(&consumer, API_STREAM_NON_BLOCKING);
+    if (result == API_SUCCESS) {
+        result = streamWaitEvent(consumer, event_end);
+        result = synchronizeStream(consumer);
+        
+        // Same ordering through a counter: the consumer parks until the
+        // producer's write reaches it
+        uint32_t batches_ready = 0;
+        result = streamWaitValue32(consumer, &batches_ready, 1, BACKEND_STREAM_WAIT_VALUE_GEQ);
+        result = streamWriteValue32(stream, &batches_ready, 1, 0);
+        result = synchronizeStream(consumer);
+        destroyStream(consumer);
+    }
+    
     // Synchronize
     result = synchronizeStream(stream);
     
+    // An async failure is visible to a poll as soon as the kernel raises it
+    backend_dim3 one = { 1, 1, 1 };
+    backendLaunch(checkedKernel, one, one, 0, (backend_stream_t)stream, (const float*)nullptr);
+    while ((result = queryStream(stream)) == API_ERROR_NOT_READY) {
+    }
+    if (result == API_ERROR_FAILED && getLastError() == BACKEND_ERROR_LAUNCH_FAILURE) {
+        result = synchronizeStream(stream);     // reported once: succeeds now
+    }
+    
+    // A scratch buffer only this stream uses: attached, filled, then read
+    // by the host after the stream has synchronized
+    unsigned char* scratch = nullptr;
+    if (backendMallocManaged((void**)&scratch, 1 << 16, BACKEND_MEM_ATTACH_GLOBAL) == BACKEND_SUCCESS) {
+        result = streamAttachMemAsync(stream, scratch, 0);
+        backendMemsetAsync(scratch, 3, 1 << 16, (backend_stream_t)stream);
+        result = synchronizeStream(stream);
+        if (scratch[(1 << 16) - 1] != 3) {
+            result = API_ERROR_FAILED;
+        }
+        backendFree(scratch);
+    }
+    
+    // Poll both markers in one call
+    api_event_t markers[2] = { event_start, event_end };
+    api_error_t marker_status[2];
+    result = queryEvents(markers, 2, marker_status);
+    
     // Measure elapsed time
     float elapsed_ms = 0.0f;
     result = elapsedTime(&elapsed_ms, event_start, event_end);
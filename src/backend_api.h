@@ -0,0 +1,6634 @@
+/**
+ * @file backend_api.h
+ * @brief Host backend for the example API translation layers
+ *
+ * Copyright (C) 2025 Timothy Deters / R.E.C.A.L.L. Foundation
+ *
+ * This file is part of the ACD Specification.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *
+ * For commercial licensing inquiries, contact the R.E.C.A.L.L. Foundation.
+ * Patent Pending: U.S. Application No. 63/898,838
+ *
+ * ---
+ *
+ * The examples translate a generic runtime API onto the backend entry
+ * points named in their TARGET_API_REF tags. This header implements that
+ * backend surface on the host:
+ *
+ *   - A stream is an in-order queue of operations. Streams with pending
+ *     work sit on the scheduler's run queue and are drained by a shared
+ *     worker pool.
+ *   - An event is a completion marker recorded into a stream. A stream
+ *     that waits on an incomplete event parks its head on the event and
+ *     is put back on the run queue by the worker that completes it.
+ *     For plain counters, a stream can instead write a 32/64-bit word
+ *     and another wait until the word compares >=, == or & a value; the
+ *     waiter parks on the word and the writing worker reschedules it.
+ *   - Events and streams publish progress in a single atomic status
+ *     word, so query calls are lock-free polls. A kernel that fails
+ *     after its launch returned sets a sticky error word beside its
+ *     stream's status, which the stream's next synchronize or query
+ *     reports. Under C++20, coroutines can co_await a stream or event;
+ *     they resume through an executor, with no thread waiting.
+ *   - Stream and event objects live in cache-aligned slabs and are named
+ *     by 64-bit handles (kind | generation | slot index), so a stale or
+ *     foreign handle is rejected with one array lookup and compare.
+ *   - Host callbacks run in stream order on a dedicated dispatcher pool,
+ *     so user code never occupies a copy/kernel worker.
+ *   - Kernels run on the host: launched functions map to registered host
+ *     callables, and a launch's blocks are spread over the workers, which
+ *     claim chunks of block indices until the grid is done. Each worker
+ *     keeps one aligned arena that serves every block's shared memory.
+ *     Lane kernels run a block's threads as fixed-width SIMD lane groups.
+ *     Cooperative launches keep all blocks resident on their own pool so
+ *     kernels can synchronize the whole grid. Typed launches carry their
+ *     arguments by value in the stream op, and batched launches queue many
+ *     small kernels as one op. A persistent kernel stays resident and
+ *     pulls work items the host pushes onto a lock-free queue.
+ *   - The host can be partitioned into devices (equal CPU runs, NUMA
+ *     nodes or L3 domains), each with its own pinned worker pools and
+ *     memory arena. Streams and allocations go to the calling thread's
+ *     current device, a thread-local. Peer copies between devices are
+ *     staged through a bounce buffer unless peer access is enabled.
+ *     Managed memory is interleaved over the devices' NUMA nodes until it
+ *     is attached to one stream, which moves it to that stream's device.
+ *   - Device properties are read from /proc and sysfs once into an
+ *     immutable snapshot published by atomic pointer; queries are a
+ *     pointer load and an explicit refresh publishes a new snapshot.
+ *   - A capturing stream records its work into a task graph; an
+ *     instantiated graph is replayed as one stream operation whose nodes
+ *     are scheduled on the workers by dependency count. If and while
+ *     nodes run a nested body graph off a graph-owned value, so loops
+ *     iterate on the workers without returning to the host.
+ *   - An executable graph can be saved to a flat, mmap-able file with
+ *     kernels and buffers referenced by registered name, and loaded by a
+ *     later process without capturing or optimizing again.
+ *   - Host threads in the synchronize calls wait under a per-object or
+ *     process-wide policy (spin, yield, futex block, or adaptive
+ *     spin-then-block) and the time spent in each mode is accounted.
+ *
+ * The header is self-contained C++11 so each example still builds as a
+ * single translation unit.
+ *
+ * Reference: ACD Standard Specification v1.0, Part 1 (SCIS)
+ * Version: 1.0.0
+ */
+
+#ifndef ACD_BACKEND_API_H
+#define ACD_BACKEND_API_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define BACKEND_HAS_COROUTINES 1
+#endif
+
+// Backend API types
+typedef int backend_error_t;
+typedef void* backend_stream_t;
+typedef void* backend_event_t;
+typedef void* backend_graph_t;
+typedef void* backend_graph_exec_t;
+typedef void* backend_graph_conditional_t;
+typedef void* backend_work_queue_t;
+typedef void (*backend_stream_callback_t)(backend_stream_t stream, backend_error_t status, void* userData);
+
+struct backend_dim3 {
+    unsigned int x;
+    unsigned int y;
+    unsigned int z;
+};
+
+// What a host kernel sees of its launch: one call per block.
+struct backend_kernel_context {
+    backend_dim3 gridDim;
+    backend_dim3 blockDim;
+    backend_dim3 blockIdx;
+    void* sharedMem;            // static shared memory, backendFuncSetStaticSharedMem bytes
+    void* dynamicSharedMem;     // the launch's sharedMem bytes, after the static part
+    void* gridBarrier;          // cooperative launches: state behind backendGridSync
+    backend_work_queue_t workQueue;     // persistent launches: the queue to pop
+    void* streamError;          // the launching stream's error word, behind backendKernelRaiseError
+};
+
+// One kernel of a backendLaunchKernelBatch call; fields as for backendLaunchKernel.
+struct backend_launch_params {
+    const void* func;
+    backend_dim3 grid;
+    backend_dim3 block;
+    void** args;
+    size_t sharedMem;
+};
+
+// Shared memory limits and usage of a registered kernel.
+struct backend_func_attributes {
+    size_t sharedSizeBytes;             // static, per block
+    size_t maxDynamicSharedSizeBytes;   // largest sharedMem a launch may pass
+};
+
+// Properties of a device, from backendGetDeviceProperties. Read-only: a
+// refresh publishes new properties and leaves earlier ones valid.
+struct backend_device_properties {
+    char name[128];                     // CPU model from /proc/cpuinfo
+    int clockRateKHz;                   // current clock of cpu0, 0 if unknown
+    unsigned int multiProcessorCount;   // kernel workers; one block runs on each
+    unsigned int onlineCpus;
+    unsigned int numaNodes;
+    size_t totalGlobalMem;              // bytes of RAM
+    size_t l1dCacheSize;                // bytes, per core
+    size_t l2CacheSize;                 // bytes, per L2 instance
+    unsigned int l2SharingCpus;         // CPUs behind one L2 instance
+    size_t l3CacheSize;                 // bytes, 0 if there is none
+    size_t sharedMemPerBlock;           // static plus dynamic limit
+    unsigned int laneWidth;             // BACKEND_LANE_WIDTH
+    unsigned int cooperativeGridLimit;
+};
+
+// Launch shape from backendSuggestLaunchConfig, one thread per element.
+struct backend_launch_config {
+    unsigned int blockSize;     // threads per block
+    unsigned int gridSize;      // blocks; gridSize * blockSize >= n
+};
+
+typedef void (*backend_host_kernel_t)(const backend_kernel_context* ctx, void** args);
+
+// 32-bit lanes per lane-kernel group; override before including to tune.
+#ifndef BACKEND_LANE_WIDTH
+#if defined(__AVX512F__)
+#define BACKEND_LANE_WIDTH 16
+#elif defined(__AVX__)
+#define BACKEND_LANE_WIDTH 8
+#else
+#define BACKEND_LANE_WIDTH 4
+#endif
+#endif
+
+enum backend_memcpy_kind {
+    BACKEND_MEMCPY_HOST_TO_HOST = 0,
+    BACKEND_MEMCPY_HOST_TO_DEVICE = 1,
+    BACKEND_MEMCPY_DEVICE_TO_HOST = 2,
+    BACKEND_MEMCPY_DEVICE_TO_DEVICE = 3,
+    BACKEND_MEMCPY_DEFAULT = 4
+};
+
+enum backend_graph_conditional_type {
+    BACKEND_GRAPH_COND_IF = 0,      // run the body once if the value is non-zero
+    BACKEND_GRAPH_COND_WHILE = 1    // run the body while the value is non-zero
+};
+
+enum backend_graph_conditional_flags {
+    BACKEND_GRAPH_COND_DEFAULT = 0,
+    BACKEND_GRAPH_COND_ASSIGN_DEFAULT = 1   // reset to the default value at every launch
+};
+
+/*
+ * Who a managed allocation is attached to. Global memory is for every
+ * device and the host; single memory is for one stream, which then gets
+ * it on its own device's node.
+ */
+enum backend_mem_attach_flags {
+    BACKEND_MEM_ATTACH_GLOBAL = 1,
+    BACKEND_MEM_ATTACH_HOST = 2,
+    BACKEND_MEM_ATTACH_SINGLE = 4
+};
+
+/*
+ * Comparison a stream value wait makes against the word at its address.
+ * GEQ compares like a wrapping sequence counter: it holds once the word
+ * has advanced to the value, i.e. (int32_t)(*addr - value) >= 0 for a
+ * 32-bit wait.
+ */
+enum backend_stream_wait_value_flags {
+    BACKEND_STREAM_WAIT_VALUE_GEQ = 0,
+    BACKEND_STREAM_WAIT_VALUE_EQ = 1,
+    BACKEND_STREAM_WAIT_VALUE_AND = 2   // (*addr & value) != 0
+};
+
+enum backend_event_flags {
+    BACKEND_EVENT_DEFAULT = 0,
+    BACKEND_EVENT_BLOCKING_SYNC = 1,
+    BACKEND_EVENT_DISABLE_TIMING = 2
+};
+
+/*
+ * How a host thread waits in backendStreamSynchronize/backendEventSynchronize.
+ * DEFAULT defers to the process-wide policy.
+ */
+enum backend_wait_policy {
+    BACKEND_WAIT_DEFAULT = 0,
+    BACKEND_WAIT_SPIN = 1,          // busy-wait with a CPU pause hint
+    BACKEND_WAIT_YIELD = 2,         // busy-wait, yielding the core each round
+    BACKEND_WAIT_BLOCK = 3,         // sleep in the kernel until woken
+    BACKEND_WAIT_ADAPTIVE = 4       // spin for a bounded time, then block
+};
+
+/*
+ * Cumulative host time spent waiting, per mode. An adaptive wait charges
+ * its spin phase to spin_ns and, if it had to sleep, the rest to block_ns;
+ * it is counted in the *_waits of the mode it finished in.
+ */
+struct backend_wait_stats {
+    uint64_t spin_ns;
+    uint64_t spin_waits;
+    uint64_t yield_ns;
+    uint64_t yield_waits;
+    uint64_t block_ns;
+    uint64_t block_waits;
+};
+
+// Error values
+const backend_error_t BACKEND_SUCCESS = 0;
+const backend_error_t BACKEND_ERROR_INVALID_VALUE = -1;
+const backend_error_t BACKEND_ERROR_OUT_OF_MEMORY = -2;
+const backend_error_t BACKEND_ERROR_NOT_READY = -3;
+const backend_error_t BACKEND_ERROR_INVALID_HANDLE = -4;
+const backend_error_t BACKEND_ERROR_CAPTURE_INVALIDATED = -5;
+const backend_error_t BACKEND_ERROR_GRAPH_UPDATE_REJECTED = -6;
+const backend_error_t BACKEND_ERROR_FILE = -7;
+const backend_error_t BACKEND_ERROR_SYMBOL_NOT_FOUND = -8;
+const backend_error_t BACKEND_ERROR_INVALID_DEVICE_FUNCTION = -9;
+const backend_error_t BACKEND_ERROR_COOPERATIVE_LAUNCH_TOO_LARGE = -10;
+const backend_error_t BACKEND_ERROR_WORK_QUEUE_CLOSED = -11;
+const backend_error_t BACKEND_ERROR_PEER_ACCESS_ALREADY_ENABLED = -12;
+const backend_error_t BACKEND_ERROR_PEER_ACCESS_NOT_ENABLED = -13;
+const backend_error_t BACKEND_ERROR_LAUNCH_FAILURE = -14;
+
+namespace backend_detail {
+
+struct Device;
+struct Stream;
+struct Event;
+struct Graph;
+struct GraphExec;
+struct GraphParams;
+struct GraphBody;
+struct GraphConditional;
+
+// Maximum operations a worker drains from one stream before putting it
+// back on the run queue, so a busy stream cannot starve the others.
+const unsigned int kDrainBudget = 64;
+
+// Spin phase of an adaptive wait. Roughly the cost of a futex sleep/wake
+// round trip: waits shorter than this never pay syscall latency, longer
+// ones burn at most this much of a core before sleeping.
+const int64_t kAdaptiveSpinNs = 20000;
+
+typedef std::chrono::steady_clock Clock;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/*
+ * Sleep/wake word for host waiters. Completers bump `epoch` after
+ * publishing new state; waiters sleep while `epoch` still holds the value
+ * they saw before checking that state. The wake syscall is skipped when
+ * nobody is asleep, so completions stay cheap for spinning waiters.
+ */
+struct WaitWord {
+    std::atomic<uint32_t> epoch;
+    std::atomic<uint32_t> sleepers;
+#if !defined(__linux__)
+    std::mutex lock;
+    std::condition_variable cv;
+#endif
+
+    WaitWord() : epoch(0), sleepers(0) {}
+
+    void wake() {
+        epoch.fetch_add(1);
+        if (sleepers.load() == 0) {
+            return;
+        }
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch),
+                FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+        { std::lock_guard<std::mutex> guard(lock); }
+        cv.notify_all();
+#endif
+    }
+
+    void sleep(uint32_t seen) {
+        sleepers.fetch_add(1);
+#if defined(__linux__)
+        if (epoch.load() == seen) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&epoch),
+                    FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+        }
+#else
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            while (epoch.load() == seen) {
+                cv.wait(guard);
+            }
+        }
+#endif
+        sleepers.fetch_sub(1);
+    }
+};
+
+struct WaitStats {
+    std::atomic<uint64_t> ns[3];
+    std::atomic<uint64_t> waits[3];
+};
+
+enum WaitMode { MODE_SPIN = 0, MODE_YIELD = 1, MODE_BLOCK = 2 };
+
+inline WaitStats& waitStats() {
+    static WaitStats stats = {};
+    return stats;
+}
+
+inline std::atomic<int>& processWaitPolicy() {
+    static std::atomic<int> policy(BACKEND_WAIT_ADAPTIVE);
+    return policy;
+}
+
+inline bool spinUseful() {
+    static const bool useful = std::thread::hardware_concurrency() > 1;
+    return useful;
+}
+
+inline int64_t elapsedNs(Clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count();
+}
+
+inline void chargeWait(WaitMode mode, int64_t ns, bool finished) {
+    WaitStats& stats = waitStats();
+    stats.ns[mode].fetch_add(static_cast<uint64_t>(ns), std::memory_order_relaxed);
+    if (finished) {
+        stats.waits[mode].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/*
+ * Host wait used by the synchronize entry points. `done` must become true
+ * only after the completer has published its state and called
+ * word.wake(). An already-satisfied wait returns without touching the clock.
+ */
+template <typename Done>
+inline void waitFor(WaitWord& word, Done done, int policy) {
+    if (done()) {
+        return;
+    }
+    if (policy == BACKEND_WAIT_DEFAULT) {
+        policy = processWaitPolicy().load(std::memory_order_relaxed);
+    }
+    Clock::time_point start = Clock::now();
+    switch (policy) {
+    case BACKEND_WAIT_SPIN:
+        while (!done()) {
+            cpuRelax();
+        }
+        chargeWait(MODE_SPIN, elapsedNs(start), true);
+        return;
+    case BACKEND_WAIT_YIELD:
+        while (!done()) {
+            std::this_thread::yield();
+        }
+        chargeWait(MODE_YIELD, elapsedNs(start), true);
+        return;
+    case BACKEND_WAIT_BLOCK:
+        break;
+    default:
+        if (!spinUseful()) {
+            // The completer needs this core; spinning only delays it
+            break;
+        }
+        for (unsigned int i = 1; ; ++i) {
+            if (done()) {
+                chargeWait(MODE_SPIN, elapsedNs(start), true);
+                return;
+            }
+            cpuRelax();
+            // Read the clock only every 64 rounds
+            if ((i & 63) == 0 && elapsedNs(start) >= kAdaptiveSpinNs) {
+                break;
+            }
+        }
+        chargeWait(MODE_SPIN, elapsedNs(start), false);
+        start = Clock::now();
+        break;
+    }
+    for (;;) {
+        uint32_t seen = word.epoch.load();
+        if (done()) {
+            break;
+        }
+        word.sleep(seen);
+    }
+    chargeWait(MODE_BLOCK, elapsedNs(start), true);
+}
+
+// Bytes of arguments (and the kernel pointer) a typed launch carries in
+// its stream op.
+const size_t kPackedArgBytes = 64;
+
+enum OpKind {
+    OP_COPY,
+    OP_MEMSET,
+    OP_RECORD_EVENT,
+    OP_WAIT_EVENT,
+    OP_HOST_CALLBACK,
+    OP_KERNEL,
+    OP_GRAPH,
+    OP_CONDITIONAL,
+    OP_KERNEL_BATCH,
+    OP_ATTACH_MEM,
+    OP_WRITE_VALUE,
+    OP_WAIT_VALUE
+};
+
+struct KernelBatch;
+
+struct StreamOp {
+    OpKind kind;
+    void* dst;
+    const void* src;
+    size_t size;
+    int value;
+    Event* event;   // RECORD/WAIT: holds a reference until retired
+    uint32_t seq;   // RECORD: sequence completed; WAIT: sequence awaited
+    backend_stream_callback_t callback;
+    void* user_data;
+    const void* func;       // KERNEL: launch parameters as passed in
+    backend_host_kernel_t entry;    // KERNEL: host callable, resolved at launch
+    size_t static_shared;           // KERNEL: the callable's static shared memory
+    bool cooperative;               // KERNEL: all blocks co-resident, may grid-sync
+    bool packed;                    // KERNEL: entry reads arguments from pack, not args
+    alignas(16) unsigned char pack[kPackedArgBytes];    // KERNEL: typed launch arguments
+    backend_dim3 grid;
+    backend_dim3 block;
+    void** args;
+    size_t shared_mem;
+    GraphExec* graph;       // GRAPH: holds a reference until retired
+    GraphParams* params;    // GRAPH: parameters snapshotted at launch, also referenced
+    GraphConditional* cond; // CONDITIONAL: value that selects the body
+    int cond_type;          // CONDITIONAL: backend_graph_conditional_type
+    KernelBatch* batch;     // KERNEL_BATCH: owned, freed once executed
+    backend_work_queue_t work_queue;    // KERNEL: persistent launch's queue, else NULL
+    bool staged;            // COPY: peer copy without peer access, via a bounce buffer
+    unsigned int attach;    // ATTACH_MEM: backend_mem_attach_flags for the block at dst
+    uint64_t word;          // WRITE_VALUE/WAIT_VALUE: value stored to, or compared with, dst
+    unsigned int compare;   // WAIT_VALUE: backend_stream_wait_value_flags
+    bool wide;              // WRITE_VALUE/WAIT_VALUE: dst is a 64-bit word, else 32-bit
+};
+
+struct Waiter {
+    Stream* stream;
+    uint32_t seq;
+};
+
+// Host continuation of an event: fn(arg) runs on the completing worker,
+// so it must only hand work off.
+struct EventNotify {
+    void (*fn)(void*);
+    void* arg;
+    uint32_t seq;
+};
+
+/*
+ * Status word: one 64-bit atomic holding a pair of 32-bit sequence
+ * counters, done (high half) and issued (low half). For an event these are
+ * the completed and recorded sequences, for a stream the retired and
+ * submitted op counts. Writers update it under the object's lock with a
+ * release store; pollers read both halves with a single acquire load and
+ * take no lock. Sequences wrap, so compare them with seqReached().
+ */
+inline uint32_t statusDone(uint64_t status) {
+    return static_cast<uint32_t>(status >> 32);
+}
+
+inline uint32_t statusIssued(uint64_t status) {
+    return static_cast<uint32_t>(status);
+}
+
+inline uint64_t makeStatus(uint32_t done, uint32_t issued) {
+    return (static_cast<uint64_t>(done) << 32) | issued;
+}
+
+inline bool seqReached(uint32_t current, uint32_t target) {
+    return static_cast<int32_t>(current - target) >= 0;
+}
+
+inline bool statusIdle(uint64_t status) {
+    return statusDone(status) == statusIssued(status);
+}
+
+/*
+ * Pooled objects are constructed once per slab slot and reused; reset()
+ * prepares a recycled object for a new handle. Status words are left
+ * running across reuse; a fresh event is unrecorded and a fresh stream is
+ * idle, so both read as complete. The status word comes first so a poll
+ * touches the same cache line as the slot's generation check.
+ */
+struct Event {
+    std::atomic<uint64_t> status;   // completed | recorded; written under lock
+    std::mutex lock;
+    WaitWord done_word;
+    std::vector<Waiter> waiters;    // stream heads parked on this event
+    std::vector<EventNotify> notifies;  // host continuations, each holding a reference
+    std::atomic<int> refs;          // host handle + queued RECORD/WAIT ops + notifies + captures recorded into
+    unsigned int flags;
+    std::atomic<int> wait_policy;
+    Graph* capture_graph;           // set by a record during stream capture
+    std::vector<uint32_t> capture_deps;  // capture nodes that record covers
+    uint64_t handle;
+
+    Event() : status(0), refs(0), flags(0),
+              wait_policy(BACKEND_WAIT_DEFAULT), capture_graph(NULL), handle(0) {}
+
+    void reset(unsigned int f) {
+        refs.store(1, std::memory_order_relaxed);
+        flags = f;
+        capture_graph = NULL;
+        capture_deps.clear();
+        wait_policy.store((f & BACKEND_EVENT_BLOCKING_SYNC) ? BACKEND_WAIT_BLOCK
+                                                            : BACKEND_WAIT_DEFAULT,
+                          std::memory_order_relaxed);
+    }
+};
+
+struct Stream {
+    std::atomic<uint64_t> status;   // retired | submitted; written under lock
+    std::atomic<int> error;         // sticky: first async error not yet reported, 0 if none
+    std::mutex lock;
+    WaitWord idle_word;
+    std::deque<StreamOp> queue;
+    std::vector<StreamOp> callback_batch;  // owned by a dispatcher while parked
+    bool scheduled;                 // on the run queue, running or parked
+    unsigned int flags;
+    std::atomic<int> wait_policy;
+    Graph* capture;                 // graph being captured into, or NULL
+    std::vector<uint32_t> capture_tail;  // nodes the next captured op depends on
+    Device* device;                 // runs its work on this device's pools
+    uint64_t handle;
+
+    Stream() : status(0), error(0), scheduled(false), flags(0),
+               wait_policy(BACKEND_WAIT_DEFAULT), capture(NULL), device(NULL), handle(0) {}
+
+    void reset(unsigned int f, Device* d) {
+        error.store(0, std::memory_order_relaxed);
+        flags = f;
+        device = d;
+        wait_policy.store(BACKEND_WAIT_DEFAULT, std::memory_order_relaxed);
+    }
+};
+
+/*
+ * A captured graph. Nodes are appended in capture order and only ever
+ * depend on earlier nodes, so node order is a topological order. Joined
+ * streams append concurrently, hence the lock; capture state on streams
+ * and events is written under their own locks (stream, then event, then
+ * graph).
+ */
+struct GraphNode {
+    StreamOp op;
+    std::vector<uint32_t> deps;
+    std::vector<uint32_t> sources;  // optimizer only: captured nodes fused into this one
+    std::shared_ptr<const GraphBody> body;  // CONDITIONAL: snapshot of the body graph
+};
+
+struct GraphBody {
+    std::vector<GraphNode> nodes;
+};
+
+/*
+ * Graph-owned condition value. Nodes write it like any other memory
+ * (backendGraphSetConditional, or a fill/copy/kernel through its address),
+ * and graph dependencies order those writes before the conditional node
+ * reads it. Shared by the graphs that use it and the executable graphs
+ * made from them.
+ */
+struct GraphConditional {
+    unsigned int value;
+    unsigned int default_value;
+    unsigned int flags;
+    std::atomic<int> refs;          // graphs and executable graphs using it
+    uint64_t handle;
+
+    GraphConditional() : value(0), default_value(0), flags(0), refs(0), handle(0) {}
+};
+
+/*
+ * Work queue feeding a persistent kernel: a bounded multi-producer,
+ * multi-consumer ring. Each cell carries a sequence number that says
+ * whether it is ready to be written or read at a given position, so push
+ * and pop each cost one CAS on their own counter and never take a lock.
+ * Idle consumers spin for the adaptive window, then sleep on `ready`.
+ */
+struct WorkQueue {
+    struct Cell {
+        std::atomic<uint64_t> seq;
+        void* item;
+    };
+
+    Cell* cells;
+    uint64_t mask;
+    char cells_pad[64 - sizeof(Cell*) - sizeof(uint64_t)];
+    std::atomic<uint64_t> tail;         // next position to push
+    char tail_pad[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<uint64_t> head;         // next position to pop
+    char head_pad[64 - sizeof(std::atomic<uint64_t>)];
+    std::atomic<bool> closed;
+    WaitWord ready;
+    uint64_t handle;
+
+    WorkQueue() : cells(NULL), mask(0), tail(0), head(0), closed(false), handle(0) {}
+
+    bool push(void* item) {
+        uint64_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.item = item;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;           // full
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(void** item) {
+        uint64_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells[pos & mask];
+            uint64_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    *item = cell.item;
+                    cell.seq.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;           // empty
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Blocks until an item arrives (true) or the queue is closed and
+    // drained (false).
+    bool waitPop(void** item) {
+        if (pop(item)) {
+            return true;
+        }
+        if (spinUseful()) {
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 1; !closed.load(std::memory_order_acquire); ++i) {
+                if (pop(item)) {
+                    return true;
+                }
+                cpuRelax();
+                if ((i & 63) == 0 && elapsedNs(start) >= kAdaptiveSpinNs) {
+                    break;
+                }
+            }
+        }
+        for (;;) {
+            uint32_t seen = ready.epoch.load();
+            if (pop(item)) {
+                return true;
+            }
+            if (closed.load(std::memory_order_acquire)) {
+                // Pushes that finished before the close are visible now
+                return pop(item);
+            }
+            ready.sleep(seen);
+        }
+    }
+};
+
+struct Graph {
+    std::mutex lock;
+    std::vector<GraphNode> nodes;
+    Stream* origin;                 // stream that began (and must end) the capture
+    std::vector<Stream*> members;   // origin plus streams joined through events
+    std::vector<Event*> captured_events;   // each holds a reference until the capture ends
+    std::vector<GraphConditional*> conditionals;  // referenced, including those of bodies
+    bool capturing;
+    bool invalidated;
+    uint64_t handle;
+
+    Graph() : origin(NULL), capturing(false), invalidated(false), handle(0) {}
+
+    void reset() {
+        nodes.clear();
+        members.clear();
+        captured_events.clear();
+        origin = NULL;
+        capturing = false;
+        invalidated = false;
+    }
+};
+
+struct GraphRun;
+
+/*
+ * Node parameters of an executable graph, in launch order. A launch
+ * snapshots the current table; backendGraphExecUpdate patches it in place
+ * when no launch holds it and replaces it otherwise, so an update only
+ * affects later launches.
+ */
+struct GraphParams {
+    std::vector<StreamOp> ops;
+    std::atomic<int> refs;              // owning exec + launches that snapshotted it
+
+    GraphParams() : refs(1) {}
+};
+
+/*
+ * Instantiated graph: successor lists in CSR form over nodes in launch
+ * order. The topology is immutable after instantiation, so concurrent
+ * launches share it; per-launch counters live in a GraphRun.
+ */
+struct GraphExec {
+    std::mutex lock;                    // params swap vs launch snapshot
+    GraphParams* params;
+    std::vector<uint32_t> succ_begin;   // successors of i: [succ_begin[i], succ_begin[i + 1])
+    std::vector<uint32_t> successors;
+    std::vector<uint32_t> indegree;
+    std::vector<uint32_t> roots;
+    // Provenance for updates: the captured topology this exec was built
+    // from, and the captured nodes each exec node was fused from
+    std::vector<unsigned char> source_kinds;
+    std::vector<uint32_t> source_dep_begin;
+    std::vector<uint32_t> source_deps;
+    std::vector<uint32_t> member_begin;
+    std::vector<uint32_t> members;
+    std::vector<GraphExec*> bodies;     // per node: instantiated body of a conditional, else NULL
+    std::vector<GraphConditional*> conditionals;  // top level: defaults applied per launch
+    std::atomic<GraphRun*> spare_run;   // last finished run, reused by the next launch
+    std::atomic<int> refs;              // host handle + queued or running launches
+    uint64_t handle;
+
+    GraphExec() : params(NULL), spare_run(NULL), refs(0), handle(0) {}
+};
+
+struct NodeTask {
+    GraphRun* run;
+    uint32_t index;
+};
+
+struct GraphRun {
+    GraphExec* exec;
+    GraphParams* params;
+    Stream* stream;
+    GraphRun* parent;                   // body runs: run of the conditional node
+    uint32_t parent_node;
+    std::unique_ptr<std::atomic<uint32_t>[]> pending;  // unfinished deps per node
+    size_t capacity;
+    std::vector<NodeTask> tasks;        // stable task arguments, one per node
+    std::atomic<uint32_t> remaining;    // nodes not yet finished
+
+    GraphRun() : exec(NULL), params(NULL), stream(NULL), parent(NULL), parent_node(0),
+                 capacity(0), remaining(0) {}
+};
+
+/*
+ * Handle layout: kind (8 bits) | generation (24 bits) | slot index (32 bits).
+ * A slot's generation is odd while a handle to it is live and is bumped on
+ * destroy, so use-after-destroy and kind confusion fail validation.
+ */
+enum HandleKind {
+    HANDLE_STREAM = 1,
+    HANDLE_EVENT = 2,
+    HANDLE_GRAPH = 3,
+    HANDLE_GRAPH_EXEC = 4,
+    HANDLE_GRAPH_CONDITIONAL = 5,
+    HANDLE_WORK_QUEUE = 6
+};
+
+const uint32_t kGenerationMask = 0xFFFFFFu;
+
+static_assert(sizeof(void*) == sizeof(uint64_t), "backend handles are 64-bit values carried in pointers");
+
+inline uint64_t makeHandle(unsigned int kind, uint32_t generation, uint32_t index) {
+    return (static_cast<uint64_t>(kind) << 56) |
+           (static_cast<uint64_t>(generation & kGenerationMask) << 32) | index;
+}
+
+inline uint64_t handleBits(const void* handle) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(handle));
+}
+
+inline void* handlePointer(uint64_t bits) {
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(bits));
+}
+
+/*
+ * Grow-only slab allocator for one handle kind. Slots are cache-line
+ * aligned so neighbouring objects never share a line; the slab directory
+ * is fixed-size so lookups never race a reallocation. Free slots are kept
+ * in a small per-thread magazine in front of a tagged lock-free stack, so
+ * create/destroy churn on one thread touches no shared cache line.
+ */
+template <typename T, unsigned int Kind>
+class SlabPool {
+public:
+    static const uint32_t kSlotsPerSlab = 256;
+    static const uint32_t kMaxSlabs = 4096;
+    static const uint32_t kMagazineSlots = 32;
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> generation;
+        std::atomic<uint32_t> next_free;    // free-list link, index + 1
+        T object;
+    };
+
+    SlabPool() : free_head_(0), slab_count_(0) {
+        for (uint32_t i = 0; i < kMaxSlabs; ++i) {
+            slabs_[i].store(NULL, std::memory_order_relaxed);
+        }
+    }
+
+    // Returns a reset-pending object with a fresh live handle, or NULL when
+    // the pool is exhausted.
+    T* acquire() {
+        uint32_t index;
+        Magazine& cache = magazine();
+        if (cache.count > 0) {
+            index = cache.slots[--cache.count];
+        } else if (!popFree(&index) && !grow(&index)) {
+            return NULL;
+        }
+        Slot* slot = at(index);
+        uint32_t generation = slot->generation.load(std::memory_order_relaxed) + 1;
+        slot->generation.store(generation, std::memory_order_release);
+        slot->object.handle = makeHandle(Kind, generation, index);
+        return &slot->object;
+    }
+
+    // O(1) validation: kind tag, directory bounds and generation compare.
+    T* lookup(const void* handle) const {
+        uint64_t bits = handleBits(handle);
+        if ((bits >> 56) != Kind) {
+            return NULL;
+        }
+        uint32_t index = static_cast<uint32_t>(bits);
+        if (index / kSlotsPerSlab >= kMaxSlabs) {
+            return NULL;
+        }
+        Slot* slab = slabs_[index / kSlotsPerSlab].load(std::memory_order_acquire);
+        if (slab == NULL) {
+            return NULL;
+        }
+        Slot* slot = &slab[index % kSlotsPerSlab];
+        uint32_t generation = slot->generation.load(std::memory_order_acquire);
+        if ((generation & 1u) == 0 ||
+            (generation & kGenerationMask) != ((bits >> 32) & kGenerationMask)) {
+            return NULL;
+        }
+        return &slot->object;
+    }
+
+    // Pulls a handle's slot toward the cache ahead of a lookup. Unvalidated
+    // handles are ignored.
+    void prefetch(const void* handle) const {
+#if defined(__GNUC__)
+        uint64_t bits = handleBits(handle);
+        uint32_t index = static_cast<uint32_t>(bits);
+        if ((bits >> 56) != Kind || index / kSlotsPerSlab >= kMaxSlabs) {
+            return;
+        }
+        Slot* slab = slabs_[index / kSlotsPerSlab].load(std::memory_order_acquire);
+        if (slab != NULL) {
+            __builtin_prefetch(&slab[index % kSlotsPerSlab]);
+        }
+#else
+        (void)handle;
+#endif
+    }
+
+    // Invalidates the object's handle; the slot stays allocated. Only the
+    // owner of the live handle writes the generation, so no RMW is needed.
+    void retire(T* object) {
+        Slot* slot = at(static_cast<uint32_t>(object->handle));
+        slot->generation.store(slot->generation.load(std::memory_order_relaxed) + 1,
+                               std::memory_order_release);
+    }
+
+    // Returns a retired object's slot to the free list.
+    void recycle(T* object) {
+        Magazine& cache = magazine();
+        if (cache.count == kMagazineSlots) {
+            // Spill half so alternating create/destroy does not thrash
+            while (cache.count > kMagazineSlots / 2) {
+                pushFree(cache.slots[--cache.count]);
+            }
+        }
+        cache.slots[cache.count++] = static_cast<uint32_t>(object->handle);
+    }
+
+private:
+    struct Magazine {
+        SlabPool* owner;
+        uint32_t count;
+        uint32_t slots[kMagazineSlots];
+
+        ~Magazine() {
+            // Thread exit: hand cached slots back to the shared stack
+            while (count > 0) {
+                owner->pushFree(slots[--count]);
+            }
+        }
+    };
+
+    Magazine& magazine() {
+        static thread_local Magazine cache = { this, 0, {} };
+        return cache;
+    }
+
+    Slot* at(uint32_t index) const {
+        return &slabs_[index / kSlotsPerSlab].load(std::memory_order_acquire)[index % kSlotsPerSlab];
+    }
+
+    bool popFree(uint32_t* index) {
+        uint64_t head = free_head_.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t link = static_cast<uint32_t>(head);
+            if (link == 0) {
+                return false;
+            }
+            uint32_t next = at(link - 1)->next_free.load(std::memory_order_relaxed);
+            uint64_t desired = (((head >> 32) + 1) << 32) | next;
+            if (free_head_.compare_exchange_weak(head, desired, std::memory_order_acquire,
+                                                 std::memory_order_acquire)) {
+                *index = link - 1;
+                return true;
+            }
+        }
+    }
+
+    void pushFree(uint32_t index) {
+        Slot* slot = at(index);
+        uint64_t head = free_head_.load(std::memory_order_relaxed);
+        for (;;) {
+            slot->next_free.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            uint64_t desired = (((head >> 32) + 1) << 32) | (index + 1);
+            if (free_head_.compare_exchange_weak(head, desired, std::memory_order_release,
+                                                 std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    // Adds a slab, keeps its first slot for the caller and frees the rest.
+    bool grow(uint32_t* index) {
+        std::lock_guard<std::mutex> guard(grow_lock_);
+        if (popFree(index)) {
+            return true;
+        }
+        uint32_t slab_index = slab_count_;
+        if (slab_index == kMaxSlabs) {
+            return false;
+        }
+        // Slabs are never freed; over-allocate to align the first slot.
+        void* raw = std::malloc(sizeof(Slot) * kSlotsPerSlab + alignof(Slot));
+        if (raw == NULL) {
+            return false;
+        }
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(raw) + alignof(Slot) - 1) &
+                            ~static_cast<uintptr_t>(alignof(Slot) - 1);
+        Slot* slab = reinterpret_cast<Slot*>(aligned);
+        for (uint32_t i = 0; i < kSlotsPerSlab; ++i) {
+            new (&slab[i]) Slot();
+        }
+        slabs_[slab_index].store(slab, std::memory_order_release);
+        slab_count_ = slab_index + 1;
+        uint32_t base = slab_index * kSlotsPerSlab;
+        for (uint32_t i = kSlotsPerSlab - 1; i > 0; --i) {
+            pushFree(base + i);
+        }
+        *index = base;
+        return true;
+    }
+
+    std::atomic<uint64_t> free_head_;   // ABA tag (high) | index + 1 (low)
+    std::atomic<Slot*> slabs_[kMaxSlabs];
+    uint32_t slab_count_;
+    std::mutex grow_lock_;
+};
+
+typedef SlabPool<Stream, HANDLE_STREAM> StreamPool;
+typedef SlabPool<Event, HANDLE_EVENT> EventPool;
+typedef SlabPool<Graph, HANDLE_GRAPH> GraphPool;
+typedef SlabPool<GraphExec, HANDLE_GRAPH_EXEC> GraphExecPool;
+typedef SlabPool<GraphConditional, HANDLE_GRAPH_CONDITIONAL> GraphConditionalPool;
+typedef SlabPool<WorkQueue, HANDLE_WORK_QUEUE> WorkQueuePool;
+
+inline StreamPool& streamPool() {
+    // Leaked like the worker pools: objects may be referenced by workers
+    // during process exit.
+    static StreamPool* pool = new StreamPool();
+    return *pool;
+}
+
+inline EventPool& eventPool() {
+    static EventPool* pool = new EventPool();
+    return *pool;
+}
+
+inline GraphPool& graphPool() {
+    static GraphPool* pool = new GraphPool();
+    return *pool;
+}
+
+inline GraphExecPool& graphExecPool() {
+    static GraphExecPool* pool = new GraphExecPool();
+    return *pool;
+}
+
+inline GraphConditionalPool& graphConditionalPool() {
+    static GraphConditionalPool* pool = new GraphConditionalPool();
+    return *pool;
+}
+
+inline WorkQueuePool& workQueuePool() {
+    static WorkQueuePool* pool = new WorkQueuePool();
+    return *pool;
+}
+
+inline Stream* lookupStream(backend_stream_t stream) {
+    return streamPool().lookup(stream);
+}
+
+inline Event* lookupEvent(backend_event_t event) {
+    return eventPool().lookup(event);
+}
+
+inline Graph* lookupGraph(backend_graph_t graph) {
+    return graphPool().lookup(graph);
+}
+
+inline GraphExec* lookupGraphExec(backend_graph_exec_t exec) {
+    return graphExecPool().lookup(exec);
+}
+
+inline GraphConditional* lookupGraphConditional(backend_graph_conditional_t cond) {
+    return graphConditionalPool().lookup(cond);
+}
+
+inline WorkQueue* lookupWorkQueue(backend_work_queue_t queue) {
+    return workQueuePool().lookup(queue);
+}
+
+struct HostKernel {
+    backend_host_kernel_t entry;
+    size_t static_shared;               // bytes of shared memory every block needs
+};
+
+/*
+ * Launchable function -> host callable and attributes. Fixed-size
+ * open-addressed table: registration takes a lock, launches probe it
+ * without one. A slot's fields are written before its key is published,
+ * and keys never move.
+ */
+class HostKernelTable {
+public:
+    static const uint32_t kSlots = 4096;
+
+    HostKernelTable() {
+        for (uint32_t i = 0; i < kSlots; ++i) {
+            slots_[i].func.store(NULL, std::memory_order_relaxed);
+            slots_[i].entry.store(NULL, std::memory_order_relaxed);
+            slots_[i].static_shared.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    bool find(const void* func, HostKernel* out) const {
+        const Slot* slot = lookup(func);
+        if (slot == NULL) {
+            return false;
+        }
+        out->entry = slot->entry.load(std::memory_order_acquire);
+        out->static_shared = slot->static_shared.load(std::memory_order_acquire);
+        return true;
+    }
+
+    // False when the table is full.
+    bool insert(const void* func, backend_host_kernel_t entry) {
+        std::lock_guard<std::mutex> guard(lock_);
+        for (uint32_t i = hash(func), probes = 0; probes < kSlots; i = (i + 1) % kSlots, ++probes) {
+            const void* key = slots_[i].func.load(std::memory_order_relaxed);
+            if (key == func) {
+                slots_[i].entry.store(entry, std::memory_order_release);
+                return true;
+            }
+            if (key == NULL) {
+                slots_[i].entry.store(entry, std::memory_order_relaxed);
+                slots_[i].func.store(func, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // False if `func` was never registered.
+    bool setStaticShared(const void* func, size_t bytes) {
+        std::lock_guard<std::mutex> guard(lock_);
+        Slot* slot = const_cast<Slot*>(lookup(func));
+        if (slot == NULL) {
+            return false;
+        }
+        slot->static_shared.store(bytes, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::atomic<const void*> func;
+        std::atomic<backend_host_kernel_t> entry;
+        std::atomic<size_t> static_shared;
+    };
+
+    static uint32_t hash(const void* func) {
+        uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(func));
+        return static_cast<uint32_t>((bits * 0x9E3779B97F4A7C15ull) >> 52) % kSlots;
+    }
+
+    const Slot* lookup(const void* func) const {
+        for (uint32_t i = hash(func), probes = 0; probes < kSlots; i = (i + 1) % kSlots, ++probes) {
+            const void* key = slots_[i].func.load(std::memory_order_acquire);
+            if (key == func) {
+                return &slots_[i];
+            }
+            if (key == NULL) {
+                return NULL;
+            }
+        }
+        return NULL;
+    }
+
+    Slot slots_[kSlots];
+    std::mutex lock_;
+};
+
+inline HostKernelTable& hostKernels() {
+    static HostKernelTable* table = new HostKernelTable();
+    return *table;
+}
+
+struct Task {
+    void (*fn)(void*);
+    void* arg;
+};
+
+/*
+ * Fixed pool of worker threads serving a FIFO run queue. Workers only ever
+ * sleep on the run queue; nothing they execute blocks on another stream.
+ * Given CPUs, every worker is pinned to that set.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(unsigned int count, const std::vector<unsigned int>& cpus = std::vector<unsigned int>())
+        : cpus_(cpus), stopping_(false) {
+        for (unsigned int i = 0; i < count; ++i) {
+            threads_.push_back(std::thread(&WorkerPool::run, this));
+        }
+    }
+
+    void submit(void (*fn)(void*), void* arg) {
+        Task task = { fn, arg };
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            tasks_.push_back(task);
+        }
+        ready_.notify_one();
+    }
+
+    // Queues `count` tasks back to back, so no other submission lands
+    // between them.
+    void submitBatch(void (*fn)(void*), void* arg, uint32_t count) {
+        Task task = { fn, arg };
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            tasks_.insert(tasks_.end(), count, task);
+        }
+        ready_.notify_all();
+    }
+
+private:
+    void pin() {
+#if defined(__linux__)
+        if (cpus_.empty()) {
+            return;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t i = 0; i < cpus_.size(); ++i) {
+            if (cpus_[i] < CPU_SETSIZE) {
+                CPU_SET(cpus_[i], &set);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+    }
+
+    void run() {
+        pin();
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> guard(lock_);
+                while (tasks_.empty() && !stopping_) {
+                    ready_.wait(guard);
+                }
+                if (stopping_) {
+                    return;
+                }
+                task = tasks_.front();
+                tasks_.pop_front();
+            }
+            task.fn(task.arg);
+        }
+    }
+
+    const std::vector<unsigned int> cpus_;
+    std::mutex lock_;
+    std::condition_variable ready_;
+    std::deque<Task> tasks_;
+    std::vector<std::thread> threads_;
+    bool stopping_;
+};
+
+/*
+ * Host topology from /proc and sysfs, shared by device partitioning and
+ * the device properties.
+ */
+// Reads a sysfs attribute into buf; false if it is missing or empty.
+inline bool readSysfsText(const std::string& path, char* buf, size_t size) {
+    FILE* f = std::fopen(path.c_str(), "r");
+    if (f == NULL) {
+        return false;
+    }
+    size_t n = std::fread(buf, 1, size - 1, f);
+    std::fclose(f);
+    buf[n] = '\0';
+    return n > 0;
+}
+
+// "48K", "2048K", "2M" -> bytes
+inline size_t parseCacheSize(const char* text) {
+    char* end = NULL;
+    unsigned long long value = std::strtoull(text, &end, 10);
+    if (*end == 'K') {
+        value <<= 10;
+    } else if (*end == 'M') {
+        value <<= 20;
+    }
+    return static_cast<size_t>(value);
+}
+
+// "0-3,8,10-11" -> 0 1 2 3 8 10 11, appended to cpus
+inline void parseCpuList(const char* text, std::vector<unsigned int>* cpus) {
+    while (*text >= '0' && *text <= '9') {
+        char* end = NULL;
+        unsigned long first = std::strtoul(text, &end, 10);
+        unsigned long last = first;
+        if (*end == '-') {
+            last = std::strtoul(end + 1, &end, 10);
+        }
+        for (unsigned long cpu = first; cpu <= last; ++cpu) {
+            cpus->push_back(static_cast<unsigned int>(cpu));
+        }
+        text = *end == ',' ? end + 1 : end;
+    }
+}
+
+inline unsigned int countCpuList(const char* text) {
+    std::vector<unsigned int> cpus;
+    parseCpuList(text, &cpus);
+    return static_cast<unsigned int>(cpus.size());
+}
+
+// Value of the first "key : value" line of a /proc file, or false.
+inline bool readProcField(const char* path, const char* key, char* buf, size_t size) {
+    FILE* f = std::fopen(path, "r");
+    if (f == NULL) {
+        return false;
+    }
+    char line[512];
+    size_t key_length = std::strlen(key);
+    bool found = false;
+    while (!found && std::fgets(line, sizeof(line), f) != NULL) {
+        if (std::strncmp(line, key, key_length) != 0) {
+            continue;
+        }
+        const char* value = std::strchr(line + key_length, ':');
+        if (value == NULL) {
+            continue;
+        }
+        value += std::strspn(value + 1, " \t") + 1;
+        size_t n = std::strcspn(value, "\n");
+        n = std::min(n, size - 1);
+        std::memcpy(buf, value, n);
+        buf[n] = '\0';
+        found = true;
+    }
+    std::fclose(f);
+    return found;
+}
+
+// CPUs online now, or 0..hardware_concurrency-1 where sysfs is missing.
+inline std::vector<unsigned int> onlineCpus() {
+    std::vector<unsigned int> cpus;
+    char text[1024];
+    if (readSysfsText("/sys/devices/system/cpu/online", text, sizeof(text))) {
+        parseCpuList(text, &cpus);
+    }
+    if (cpus.empty()) {
+        for (unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+/*
+ * Devices. The host is split into one or more devices, each a partition
+ * of the online CPUs with its own kernel worker pools, pinned to those
+ * CPUs, and its own memory arena. Streams belong to the device that was
+ * current when they were created and all their work runs on its pools;
+ * events, graphs and work queues are not tied to a device. The partition
+ * is fixed the first time a device is used: backendConfigureDevices, or
+ * the BACKEND_DEVICES environment variable, or one device spanning the
+ * whole host.
+ */
+const int kMaxDevices = 64;
+
+struct DevicePartition {
+    std::vector<unsigned int> cpus;     // empty: the whole host, not pinned
+    int numa_node;                      // -1 unless split by NUMA node
+};
+
+// "N": N devices over equal runs of the online CPUs (CPUs are shared
+// round-robin when there are fewer CPUs than devices); "numa": one per
+// NUMA node with CPUs; "l3": one per L3 cache instance. A layout that
+// sysfs cannot describe yields a single device. False if malformed.
+inline bool partitionHost(const std::string& spec, std::vector<DevicePartition>* parts) {
+    std::vector<unsigned int> online = onlineCpus();
+    DevicePartition whole;
+    whole.numa_node = -1;
+    parts->clear();
+    if (spec == "numa") {
+        char text[1024];
+        std::vector<unsigned int> nodes;
+        if (readSysfsText("/sys/devices/system/node/online", text, sizeof(text))) {
+            parseCpuList(text, &nodes);
+        }
+        for (size_t i = 0; i < nodes.size() && parts->size() < static_cast<size_t>(kMaxDevices); ++i) {
+            DevicePartition part;
+            part.numa_node = static_cast<int>(nodes[i]);
+            std::string path = "/sys/devices/system/node/node" + std::to_string(nodes[i]) + "/cpulist";
+            if (readSysfsText(path, text, sizeof(text))) {
+                parseCpuList(text, &part.cpus);
+            }
+            if (!part.cpus.empty()) {
+                parts->push_back(part);
+            }
+        }
+    } else if (spec == "l3") {
+        std::vector<bool> assigned(online.empty() ? 0 : online.back() + 1, false);
+        for (size_t i = 0; i < online.size() && parts->size() < static_cast<size_t>(kMaxDevices); ++i) {
+            if (assigned[online[i]]) {
+                continue;
+            }
+            DevicePartition part;
+            part.numa_node = -1;
+            for (int index = 0; index < 8; ++index) {
+                std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(online[i]) +
+                                  "/cache/index" + std::to_string(index) + "/";
+                char level[16], cpus[1024];
+                if (!readSysfsText(dir + "level", level, sizeof(level))) {
+                    break;
+                }
+                if (level[0] == '3' && readSysfsText(dir + "shared_cpu_list", cpus, sizeof(cpus))) {
+                    parseCpuList(cpus, &part.cpus);
+                    break;
+                }
+            }
+            if (part.cpus.empty()) {
+                parts->clear();
+                break;
+            }
+            for (size_t c = 0; c < part.cpus.size(); ++c) {
+                if (part.cpus[c] < assigned.size()) {
+                    assigned[part.cpus[c]] = true;
+                }
+            }
+            parts->push_back(part);
+        }
+    } else {
+        char* end = NULL;
+        long count = std::strtol(spec.c_str(), &end, 10);
+        if (spec.empty() || *end != '\0' || count < 1 || count > kMaxDevices) {
+            return false;
+        }
+        if (count == 1) {
+            parts->push_back(whole);
+            return true;
+        }
+        size_t total = online.size();
+        for (long d = 0; d < count; ++d) {
+            DevicePartition part;
+            part.numa_node = -1;
+            if (total < static_cast<size_t>(count)) {
+                part.cpus.push_back(online[d % total]);
+            } else {
+                part.cpus.assign(online.begin() + total * d / count, online.begin() + total * (d + 1) / count);
+            }
+            parts->push_back(part);
+        }
+    }
+    if (parts->size() <= 1) {
+        parts->assign(1, whole);
+    }
+    return true;
+}
+
+/*
+ * Device memory, one arena per device. Each block is its own page-rounded
+ * mapping; on a NUMA device it is bound to the device's node, so its
+ * pages fault in there whichever thread touches them first. Freed blocks
+ * are kept by size, up to a cap, and handed out again before mapping new
+ * ones. Contents of a new block are unspecified.
+ */
+const size_t kArenaCacheBytes = 64u << 20;
+
+class DeviceArena {
+public:
+    explicit DeviceArena(int numa_node) : numa_node_(numa_node), cached_bytes_(0) {}
+
+    void* allocate(size_t size) {
+        size = roundUp(size);
+        void* block = NULL;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            std::multimap<size_t, void*>::iterator it = cached_.find(size);
+            if (it != cached_.end()) {
+                block = it->second;
+                cached_.erase(it);
+                cached_bytes_ -= size;
+            }
+        }
+        if (block == NULL) {
+            block = mapBlock(size);
+            if (block == NULL) {
+                return NULL;
+            }
+        }
+        std::lock_guard<std::mutex> guard(lock_);
+        live_[reinterpret_cast<uintptr_t>(block)] = size;
+        return block;
+    }
+
+    // False if `block` is not a live allocation of this arena.
+    bool release(void* block) {
+        size_t size;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            std::map<uintptr_t, size_t>::iterator it = live_.find(reinterpret_cast<uintptr_t>(block));
+            if (it == live_.end()) {
+                return false;
+            }
+            size = it->second;
+            live_.erase(it);
+            if (cached_bytes_ + size <= kArenaCacheBytes) {
+                cached_.insert(std::make_pair(size, block));
+                cached_bytes_ += size;
+                return true;
+            }
+        }
+        unmapBlock(block, size);
+        return true;
+    }
+
+    // True if [ptr, ptr + size) lies inside one live allocation.
+    bool owns(const void* ptr, size_t size) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        std::lock_guard<std::mutex> guard(lock_);
+        std::map<uintptr_t, size_t>::iterator it = live_.upper_bound(address);
+        if (it == live_.begin()) {
+            return false;
+        }
+        --it;
+        return address - it->first <= it->second && size <= it->second - (address - it->first);
+    }
+
+private:
+    static size_t roundUp(size_t size) {
+        const size_t page = 4096;
+        return (size + page - 1) & ~(page - 1);
+    }
+
+    void* mapBlock(size_t size) {
+#if defined(__unix__) || defined(__APPLE__)
+        void* block = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (block == MAP_FAILED) {
+            return NULL;
+        }
+#if defined(__linux__)
+        if (numa_node_ >= 0 && numa_node_ < 64) {
+            unsigned long nodes = 1ul << numa_node_;
+            syscall(SYS_mbind, block, size, MPOL_PREFERRED, &nodes, 64ul, 0u);
+        }
+#endif
+        return block;
+#else
+        return std::malloc(size);
+#endif
+    }
+
+    static void unmapBlock(void* block, size_t size) {
+#if defined(__unix__) || defined(__APPLE__)
+        munmap(block, size);
+#else
+        (void)size;
+        std::free(block);
+#endif
+    }
+
+    int numa_node_;
+    std::mutex lock_;
+    std::map<uintptr_t, size_t> live_;          // base -> size
+    std::multimap<size_t, void*> cached_;       // freed blocks by size
+    size_t cached_bytes_;
+};
+
+// Callback dispatchers are separate threads so a slow user callback only
+// holds up its own stream; other streams keep their workers and, until
+// every dispatcher is busy, their callbacks still run.
+inline unsigned int dispatcherCount() {
+    unsigned int count = std::thread::hardware_concurrency() / 2;
+    return count < 2 ? 2 : count;
+}
+
+inline WorkerPool& dispatchers() {
+    static WorkerPool* pool = new WorkerPool(dispatcherCount());
+    return *pool;
+}
+
+/*
+ * A device: its CPUs, its arena and two worker pools. Cooperative
+ * launches run one block per thread of the second pool, sized like the
+ * first, because their blocks wait on each other at grid barriers. A
+ * launch's blocks are queued back to back and at most one per thread, so
+ * the oldest unfinished launch always has the front of the queue and
+ * every block it still needs gets a thread: blocks are co-resident and
+ * launches cannot deadlock each other.
+ */
+struct Device {
+    int index;
+    DevicePartition partition;
+    DeviceArena arena;
+    std::atomic<uint64_t> peers;    // bit i: peer access to device i enabled
+
+    Device(int i, const DevicePartition& p) : index(i), partition(p), arena(p.numa_node), peers(0),
+                                              workers_(NULL), cooperative_(NULL) {}
+
+    WorkerPool& workers();
+    WorkerPool& cooperativeWorkers();
+
+private:
+    // Started on first use and intentionally leaked: workers may still be
+    // draining streams while static destructors run at process exit.
+    std::once_flag workers_once_;
+    std::once_flag cooperative_once_;
+    WorkerPool* workers_;
+    WorkerPool* cooperative_;
+};
+
+struct DeviceTable {
+    std::vector<Device*> devices;
+    unsigned int worker_count;      // per pool, the same on every device
+};
+
+struct DeviceConfig {
+    std::mutex lock;
+    std::string partition;          // from backendConfigureDevices
+    bool fixed;                     // the table has been built
+
+    DeviceConfig() : fixed(false) {}
+};
+
+inline DeviceConfig& deviceConfig() {
+    static DeviceConfig* config = new DeviceConfig();
+    return *config;
+}
+
+// Every device gets as many workers as the largest partition has CPUs
+// (at least two), so a cooperative grid that fits one device fits all
+// and captured or saved graphs run on any of them.
+inline DeviceTable* buildDeviceTable() {
+    DeviceConfig& config = deviceConfig();
+    std::lock_guard<std::mutex> guard(config.lock);
+    std::string spec = config.partition;
+    if (spec.empty()) {
+        const char* env = std::getenv("BACKEND_DEVICES");
+        spec = env != NULL ? env : "1";
+    }
+    std::vector<DevicePartition> parts;
+    if (!partitionHost(spec, &parts)) {
+        partitionHost("1", &parts);
+    }
+    DeviceTable* table = new DeviceTable();
+    size_t widest = std::thread::hardware_concurrency();
+    if (parts.size() > 1) {
+        widest = 0;
+        for (size_t i = 0; i < parts.size(); ++i) {
+            widest = std::max(widest, parts[i].cpus.size());
+        }
+    }
+    table->worker_count = static_cast<unsigned int>(std::max<size_t>(2, widest));
+    for (size_t i = 0; i < parts.size(); ++i) {
+        table->devices.push_back(new Device(static_cast<int>(i), parts[i]));
+    }
+    config.fixed = true;
+    return table;
+}
+
+inline DeviceTable& deviceTable() {
+    static DeviceTable* table = buildDeviceTable();
+    return *table;
+}
+
+// Threads per worker pool of every device. Read on every kernel launch.
+inline unsigned int workerCount() {
+    static const unsigned int count = deviceTable().worker_count;
+    return count;
+}
+
+inline WorkerPool& Device::workers() {
+    std::call_once(workers_once_, [this] {
+        workers_ = new WorkerPool(workerCount(), partition.cpus);
+    });
+    return *workers_;
+}
+
+inline WorkerPool& Device::cooperativeWorkers() {
+    std::call_once(cooperative_once_, [this] {
+        cooperative_ = new WorkerPool(workerCount(), partition.cpus);
+    });
+    return *cooperative_;
+}
+
+// The calling thread's current device, by index; see backendSetDevice.
+inline int& currentDeviceIndex() {
+    static thread_local int index = 0;
+    return index;
+}
+
+inline Device* currentDevice() {
+    return deviceTable().devices[currentDeviceIndex()];
+}
+
+inline bool validDevice(int device) {
+    return device >= 0 && static_cast<size_t>(device) < deviceTable().devices.size();
+}
+
+/*
+ * Peer copies. All device memory is host memory, so every device can
+ * address every other's; peer access decides the path. With access
+ * enabled between two devices, in either direction, a copy is one memmove
+ * from arena to arena. Without it the copy is staged the way it is
+ * between devices that cannot map each other: chunk by chunk through a
+ * bounce buffer owned by the copying thread.
+ */
+const size_t kPeerStagingBytes = 256 * 1024;
+
+inline bool peerAccessEnabled(int a, int b) {
+    const std::vector<Device*>& devices = deviceTable().devices;
+    return a == b ||
+           (devices[a]->peers.load(std::memory_order_acquire) & (1ull << b)) != 0 ||
+           (devices[b]->peers.load(std::memory_order_acquire) & (1ull << a)) != 0;
+}
+
+inline void stagedCopy(void* dst, const void* src, size_t size) {
+    static thread_local std::unique_ptr<char[]> bounce(new char[kPeerStagingBytes]);
+    for (size_t offset = 0; offset < size; offset += kPeerStagingBytes) {
+        size_t n = std::min(kPeerStagingBytes, size - offset);
+        std::memcpy(bounce.get(), static_cast<const char*>(src) + offset, n);
+        std::memcpy(static_cast<char*>(dst) + offset, bounce.get(), n);
+    }
+}
+
+// Validates a peer copy's devices and ranges; sets *staged to the path.
+inline backend_error_t checkPeerCopy(void* dst, int dst_device, const void* src, int src_device,
+                                     size_t size, bool* staged) {
+    if (dst == NULL || src == NULL || size == 0 || !validDevice(dst_device) || !validDevice(src_device)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    const std::vector<Device*>& devices = deviceTable().devices;
+    if (!devices[dst_device]->arena.owns(dst, size) || !devices[src_device]->arena.owns(src, size)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *staged = !peerAccessEnabled(dst_device, src_device);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * Managed memory: blocks that any device and the host may use, placed by
+ * attachment. Each block is its own mapping. Global and host blocks are
+ * interleaved over the NUMA nodes of the devices (when there are several)
+ * so no device has all of its accesses go remote. Attaching a block to one
+ * stream is a stream op: on that stream's worker it rebinds the block to
+ * the device's node, moves the pages already there and faults in the rest,
+ * so the stream's later work starts on resident local pages and no other
+ * device is charged for keeping it placed. The registry records who each
+ * block is attached to; a destroyed stream's blocks go back to global.
+ */
+struct ManagedBlock {
+    size_t size;
+    unsigned int attach;
+    Stream* owner;          // ATTACH_SINGLE: the stream, else NULL
+};
+
+struct ManagedRegistry {
+    std::mutex lock;
+    std::map<uintptr_t, ManagedBlock> blocks;   // base -> block
+};
+
+inline ManagedRegistry& managedRegistry() {
+    static ManagedRegistry* registry = new ManagedRegistry();
+    return *registry;
+}
+
+// Applies the placement for `attach` to a block; `device` is the owner's
+// device for ATTACH_SINGLE. Pages are only moved when `move` is set.
+inline void placeManaged(void* block, size_t size, unsigned int attach, const Device* device, bool move) {
+#if defined(__linux__)
+    unsigned long nodes = 0;
+    int mode = MPOL_DEFAULT;
+    if (attach == BACKEND_MEM_ATTACH_SINGLE) {
+        if (device->partition.numa_node >= 0 && device->partition.numa_node < 64) {
+            nodes = 1ul << device->partition.numa_node;
+            mode = MPOL_PREFERRED;
+        }
+    } else {
+        const std::vector<Device*>& devices = deviceTable().devices;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            int node = devices[i]->partition.numa_node;
+            if (node >= 0 && node < 64) {
+                nodes |= 1ul << node;
+            }
+        }
+        if ((nodes & (nodes - 1)) != 0) {
+            mode = MPOL_INTERLEAVE;
+        }
+    }
+    syscall(SYS_mbind, block, size, mode, mode == MPOL_DEFAULT ? NULL : &nodes, 64ul,
+            move ? static_cast<unsigned>(MPOL_MF_MOVE) : 0u);
+#else
+    (void)block;
+    (void)size;
+    (void)attach;
+    (void)device;
+    (void)move;
+#endif
+}
+
+// Faults in every page of a block, writable, without touching its bytes.
+inline void populateManaged(void* block, size_t size) {
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+    madvise(block, size, MADV_POPULATE_WRITE);
+#else
+    (void)block;
+    (void)size;
+#endif
+}
+
+// ATTACH_MEM op, run on the attaching stream's worker.
+inline void attachManaged(const StreamOp& op, Stream* stream) {
+    ManagedRegistry& registry = managedRegistry();
+    size_t size;
+    {
+        std::lock_guard<std::mutex> guard(registry.lock);
+        std::map<uintptr_t, ManagedBlock>::iterator it = registry.blocks.find(reinterpret_cast<uintptr_t>(op.dst));
+        if (it == registry.blocks.end()) {
+            return;
+        }
+        it->second.attach = op.attach;
+        it->second.owner = op.attach == BACKEND_MEM_ATTACH_SINGLE ? stream : NULL;
+        size = it->second.size;
+    }
+    placeManaged(op.dst, size, op.attach, stream->device, true);
+    if (op.attach == BACKEND_MEM_ATTACH_SINGLE) {
+        populateManaged(op.dst, size);
+    }
+}
+
+// A stream is going away: blocks attached to it become global again.
+inline void detachManaged(Stream* stream) {
+    ManagedRegistry& registry = managedRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    std::map<uintptr_t, ManagedBlock>::iterator it = registry.blocks.begin();
+    for (; it != registry.blocks.end(); ++it) {
+        if (it->second.owner == stream) {
+            it->second.attach = BACKEND_MEM_ATTACH_GLOBAL;
+            it->second.owner = NULL;
+            placeManaged(reinterpret_cast<void*>(it->first), it->second.size, BACKEND_MEM_ATTACH_GLOBAL,
+                         NULL, false);
+        }
+    }
+}
+
+/*
+ * Sense-reversing grid barrier. Arrivals count up on one cache line; the
+ * last arrival resets the count and flips the sense on another, which the
+ * waiters watch, so each episode costs one shared write per block and
+ * one invalidation of the waiters' line. Waiters spin for the adaptive
+ * window, then sleep on `word`.
+ */
+struct GridBarrier {
+    std::atomic<uint32_t> arrived;
+    char arrived_pad[64 - sizeof(std::atomic<uint32_t>)];
+    std::atomic<uint32_t> sense;
+    uint32_t count;
+    WaitWord word;
+
+    explicit GridBarrier(uint32_t participants) : arrived(0), sense(0), count(participants) {}
+
+    void wait() {
+        uint32_t mine = sense.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+            arrived.store(0, std::memory_order_relaxed);
+            sense.store(mine ^ 1, std::memory_order_release);
+            word.wake();
+            return;
+        }
+        if (spinUseful()) {
+            Clock::time_point start = Clock::now();
+            for (unsigned int i = 1; sense.load(std::memory_order_acquire) == mine; ++i) {
+                cpuRelax();
+                if ((i & 63) == 0 && elapsedNs(start) >= kAdaptiveSpinNs) {
+                    break;
+                }
+            }
+        }
+        for (;;) {
+            uint32_t seen = word.epoch.load();
+            if (sense.load(std::memory_order_acquire) != mine) {
+                return;
+            }
+            word.sleep(seen);
+        }
+    }
+};
+
+inline void releaseEvent(Event* e) {
+    // References are only taken by a thread that already holds one (the
+    // handle's, a queued op's or a continuation's), so a count of one seen
+    // here is the caller's own and cannot grow again: skip the RMW for the
+    // common destroy-after-completion case.
+    if (e->refs.load(std::memory_order_acquire) == 1 ||
+        e->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        eventPool().recycle(e);
+    }
+}
+
+// Once the owning exec has let go of a table nobody can take a new
+// reference to it, so a count of one seen here is final.
+inline void releaseGraphParams(GraphParams* p) {
+    if (p->refs.load(std::memory_order_acquire) == 1 ||
+        p->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete p;
+    }
+}
+
+// Adds the conditionals in `add` that `owned` does not reference yet.
+inline void retainConditionals(std::vector<GraphConditional*>* owned,
+                               const std::vector<GraphConditional*>& add) {
+    for (size_t i = 0; i < add.size(); ++i) {
+        if (std::find(owned->begin(), owned->end(), add[i]) == owned->end()) {
+            add[i]->refs.fetch_add(1, std::memory_order_relaxed);
+            owned->push_back(add[i]);
+        }
+    }
+}
+
+inline void releaseConditionals(std::vector<GraphConditional*>* owned) {
+    for (size_t i = 0; i < owned->size(); ++i) {
+        GraphConditional* c = (*owned)[i];
+        if (c->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            graphConditionalPool().retire(c);
+            graphConditionalPool().recycle(c);
+        }
+    }
+    owned->clear();
+}
+
+inline void releaseGraphExec(GraphExec* x) {
+    if (x->refs.load(std::memory_order_acquire) == 1 ||
+        x->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // Bodies are owned by this exec alone and never had a user handle
+        for (size_t i = 0; i < x->bodies.size(); ++i) {
+            if (x->bodies[i] != NULL) {
+                graphExecPool().retire(x->bodies[i]);
+                releaseGraphExec(x->bodies[i]);
+            }
+        }
+        x->bodies.clear();
+        releaseConditionals(&x->conditionals);
+        releaseGraphParams(x->params);
+        x->params = NULL;
+        graphExecPool().recycle(x);
+    }
+}
+
+inline void drainStream(void* arg);
+
+// Returns true if `seq` has already completed; otherwise parks `s` on the
+// event and returns false. Called with the stream lock held.
+inline bool parkOnEvent(Event* e, uint32_t seq, Stream* s) {
+    std::lock_guard<std::mutex> guard(e->lock);
+    if (seqReached(statusDone(e->status.load(std::memory_order_relaxed)), seq)) {
+        return true;
+    }
+    Waiter waiter = { s, seq };
+    e->waiters.push_back(waiter);
+    return false;
+}
+
+// Retires record `seq`, puts every stream parked on it back on the run
+// queue and runs the continuations it satisfies. Completion is monotonic:
+// retiring a later record also satisfies waiters of earlier ones. Each
+// continuation's reference is dropped through releaseEvent once it has
+// run, which recycles the event if the handle was destroyed meanwhile and
+// nothing else holds it.
+inline void completeEvent(Event* e, uint32_t seq) {
+    std::vector<Stream*> ready;
+    std::vector<EventNotify> notified;
+    {
+        std::lock_guard<std::mutex> guard(e->lock);
+        uint64_t status = e->status.load(std::memory_order_relaxed);
+        uint32_t completed = statusDone(status);
+        if (!seqReached(completed, seq)) {
+            completed = seq;
+            e->status.store(makeStatus(completed, statusIssued(status)),
+                            std::memory_order_release);
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < e->waiters.size(); ++i) {
+            if (seqReached(completed, e->waiters[i].seq)) {
+                ready.push_back(e->waiters[i].stream);
+            } else {
+                e->waiters[kept++] = e->waiters[i];
+            }
+        }
+        e->waiters.resize(kept);
+        kept = 0;
+        for (size_t i = 0; i < e->notifies.size(); ++i) {
+            if (seqReached(completed, e->notifies[i].seq)) {
+                notified.push_back(e->notifies[i]);
+            } else {
+                e->notifies[kept++] = e->notifies[i];
+            }
+        }
+        e->notifies.resize(kept);
+    }
+    e->done_word.wake();
+    for (size_t i = 0; i < ready.size(); ++i) {
+        ready[i]->device->workers().submit(drainStream, ready[i]);
+    }
+    for (size_t i = 0; i < notified.size(); ++i) {
+        notified[i].fn(notified[i].arg);
+        releaseEvent(e);
+    }
+}
+
+// Arranges for fn(arg) to run once everything recorded on `e` so far has
+// completed. Returns false, queueing nothing, if it already has.
+inline bool notifyOnEvent(Event* e, void (*fn)(void*), void* arg) {
+    std::lock_guard<std::mutex> guard(e->lock);
+    uint64_t status = e->status.load(std::memory_order_relaxed);
+    if (statusIdle(status)) {
+        return false;
+    }
+    EventNotify notify = { fn, arg, statusIssued(status) };
+    e->notifies.push_back(notify);
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/*
+ * Value waits. A stream whose head waits on a memory word parks in the
+ * bucket the word's address hashes to; writing the word through a
+ * write-value op (or backendNotifyValue) puts back on the run queue
+ * every stream parked on it whose comparison now holds. A write with no
+ * stream parked in its bucket takes no lock: the writer stores the word
+ * and then reads `parked`, a waiter raises `parked` and then re-reads the
+ * word, all sequentially consistent, so one of them sees the other.
+ */
+struct ValueWaiter {
+    Stream* stream;
+    const StreamOp* wait;   // the stream's head, which stays put while it is parked
+};
+
+/*
+ * Direct handoff. While a worker drains a stream, a value write that wakes
+ * a stream of the same device leaves it here instead of on the run queue.
+ * If the writer's stream then has nothing runnable (typically it parks on
+ * the reply), the worker drains the woken stream next with the rest of
+ * its budget, so a ping-pong between streams costs no run-queue round trip
+ * and no thread wake-up. If the writer's stream keeps running, the woken
+ * stream goes on the run queue as usual.
+ */
+struct DrainHandoff {
+    Device* device;     // device of the stream being drained
+    Stream* stream;     // woken stream to drain next, or NULL
+};
+
+// The handoff of the drainStream running on this thread, or NULL.
+inline DrainHandoff*& drainHandoff() {
+    static thread_local DrainHandoff* current = NULL;
+    return current;
+}
+
+struct ValueWaitBucket {
+    std::mutex lock;
+    std::atomic<uint32_t> parked;
+    std::vector<ValueWaiter> waiters;
+
+    ValueWaitBucket() : parked(0) {}
+};
+
+const size_t kValueWaitBuckets = 64;
+
+inline ValueWaitBucket& valueWaitBucket(const void* addr) {
+    static ValueWaitBucket* buckets = new ValueWaitBucket[kValueWaitBuckets];
+    return buckets[(reinterpret_cast<uintptr_t>(addr) >> 3) % kValueWaitBuckets];
+}
+
+inline bool valueReached(const StreamOp& wait) {
+    uint64_t current = wait.wide ? __atomic_load_n(static_cast<uint64_t*>(wait.dst), __ATOMIC_SEQ_CST)
+                                 : __atomic_load_n(static_cast<uint32_t*>(wait.dst), __ATOMIC_SEQ_CST);
+    switch (wait.compare) {
+    case BACKEND_STREAM_WAIT_VALUE_EQ:
+        return current == wait.word;
+    case BACKEND_STREAM_WAIT_VALUE_AND:
+        return (current & wait.word) != 0;
+    default:
+        return wait.wide ? static_cast<int64_t>(current - wait.word) >= 0
+                         : seqReached(static_cast<uint32_t>(current), static_cast<uint32_t>(wait.word));
+    }
+}
+
+// Returns true if the wait at the head of `s` holds; otherwise parks `s`
+// on the word and returns false. Called with the stream lock held; `wait`
+// is the queue head, which only the stream's drainer pops, so the writer
+// may read it without that lock.
+inline bool parkOnValue(const StreamOp& wait, Stream* s) {
+    if (valueReached(wait)) {
+        return true;
+    }
+    ValueWaitBucket& bucket = valueWaitBucket(wait.dst);
+    std::lock_guard<std::mutex> guard(bucket.lock);
+    bucket.parked.fetch_add(1);
+    if (valueReached(wait)) {
+        bucket.parked.fetch_sub(1);
+        return true;
+    }
+    ValueWaiter waiter = { s, &wait };
+    bucket.waiters.push_back(waiter);
+    return false;
+}
+
+// Reschedules the streams parked on `addr` whose wait now holds; the
+// word must already have been stored.
+inline void wakeValueWaiters(const void* addr) {
+    ValueWaitBucket& bucket = valueWaitBucket(addr);
+    if (bucket.parked.load() == 0) {
+        return;
+    }
+    std::vector<Stream*> ready;
+    {
+        std::lock_guard<std::mutex> guard(bucket.lock);
+        size_t kept = 0;
+        for (size_t i = 0; i < bucket.waiters.size(); ++i) {
+            const ValueWaiter& w = bucket.waiters[i];
+            if (w.wait->dst == addr && valueReached(*w.wait)) {
+                ready.push_back(w.stream);
+            } else {
+                bucket.waiters[kept++] = w;
+            }
+        }
+        bucket.waiters.resize(kept);
+        bucket.parked.fetch_sub(static_cast<uint32_t>(ready.size()));
+    }
+    DrainHandoff* handoff = drainHandoff();
+    for (size_t i = 0; i < ready.size(); ++i) {
+        if (handoff != NULL && handoff->stream == NULL && ready[i]->device == handoff->device) {
+            handoff->stream = ready[i];
+        } else {
+            ready[i]->device->workers().submit(drainStream, ready[i]);
+        }
+    }
+}
+
+inline void writeValue(const StreamOp& op) {
+    if (op.wide) {
+        __atomic_store_n(static_cast<uint64_t*>(op.dst), op.word, __ATOMIC_SEQ_CST);
+    } else {
+        __atomic_store_n(static_cast<uint32_t*>(op.dst), static_cast<uint32_t>(op.word), __ATOMIC_SEQ_CST);
+    }
+    wakeValueWaiters(op.dst);
+}
+
+inline uint64_t kernelBlockCount(const StreamOp& op) {
+    return static_cast<uint64_t>(op.grid.x) * op.grid.y * op.grid.z;
+}
+
+/*
+ * Per-block shared memory. Each worker owns one cache-aligned arena that
+ * grows to the largest request it has served and is reused by every
+ * block it runs afterwards, so blocks never allocate. Contents are not
+ * preserved between blocks.
+ */
+const size_t kSharedMemAlignment = 64;
+const size_t kMaxSharedMemPerBlock = 48 * 1024;
+
+// Arena bytes for a launch: static part, padded to a cache line, then
+// the dynamic part.
+inline size_t kernelSharedBytes(size_t static_bytes, size_t dynamic_bytes) {
+    return ((static_bytes + kSharedMemAlignment - 1) & ~(kSharedMemAlignment - 1)) + dynamic_bytes;
+}
+
+/*
+ * Device properties. The host backend reads them from /proc/cpuinfo,
+ * sysfs (cache sizes of each device's first CPU, online CPUs, NUMA
+ * nodes) and its own limits, once, into an immutable snapshot published
+ * through an atomic pointer, so a query is a pointer load. A refresh
+ * builds and publishes a new snapshot; earlier ones are kept, never
+ * freed, so a pointer a caller already holds stays valid.
+ */
+// Fills the cache fields from sysfs. Where sysfs is missing the defaults
+// describe a typical core: 32 KiB L1d, a private 1 MiB L2, no L3.
+inline void readCacheProperties(backend_device_properties* props, unsigned int cpu) {
+    props->l1dCacheSize = 32 * 1024;
+    props->l2CacheSize = 1024 * 1024;
+    props->l2SharingCpus = 1;
+    props->l3CacheSize = 0;
+    for (int index = 0; index < 8; ++index) {
+        std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index" +
+                          std::to_string(index) + "/";
+        char level[16], type[32], size[32], cpus[256];
+        if (!readSysfsText(dir + "level", level, sizeof(level)) ||
+            !readSysfsText(dir + "type", type, sizeof(type)) ||
+            !readSysfsText(dir + "size", size, sizeof(size))) {
+            break;
+        }
+        size_t bytes = parseCacheSize(size);
+        if (bytes == 0 || std::strncmp(type, "Instruction", 11) == 0) {
+            continue;
+        }
+        if (level[0] == '1') {
+            props->l1dCacheSize = bytes;
+        } else if (level[0] == '2') {
+            props->l2CacheSize = bytes;
+            if (readSysfsText(dir + "shared_cpu_list", cpus, sizeof(cpus))) {
+                props->l2SharingCpus = std::max(1u, countCpuList(cpus));
+            }
+        } else if (level[0] == '3') {
+            props->l3CacheSize = bytes;
+        }
+    }
+}
+
+inline backend_device_properties readDeviceProperties(const Device& device, size_t device_count) {
+    const DevicePartition& part = device.partition;
+    backend_device_properties props;
+    std::memset(&props, 0, sizeof(props));
+    char text[256];
+    if (!readProcField("/proc/cpuinfo", "model name", props.name, sizeof(props.name))) {
+        std::strcpy(props.name, "Host CPU");
+    }
+    if (readProcField("/proc/cpuinfo", "cpu MHz", text, sizeof(text))) {
+        props.clockRateKHz = static_cast<int>(std::strtod(text, NULL) * 1000.0);
+    }
+    props.multiProcessorCount = workerCount();
+    props.onlineCpus = part.cpus.empty() ? static_cast<unsigned int>(onlineCpus().size())
+                                         : static_cast<unsigned int>(part.cpus.size());
+    if (part.numa_node >= 0) {
+        props.numaNodes = 1;
+    } else {
+        props.numaNodes = readSysfsText("/sys/devices/system/node/online", text, sizeof(text))
+            ? countCpuList(text) : 1;
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+        props.totalGlobalMem = static_cast<size_t>(pages) * static_cast<size_t>(page_size) / device_count;
+    }
+#endif
+    if (part.numa_node >= 0) {
+        std::string path = "/sys/devices/system/node/node" + std::to_string(part.numa_node) + "/meminfo";
+        std::string key = "Node " + std::to_string(part.numa_node) + " MemTotal";
+        if (readProcField(path.c_str(), key.c_str(), text, sizeof(text))) {
+            props.totalGlobalMem = static_cast<size_t>(std::strtoull(text, NULL, 10)) << 10;
+        }
+    }
+    readCacheProperties(&props, part.cpus.empty() ? 0 : part.cpus[0]);
+    props.sharedMemPerBlock = kMaxSharedMemPerBlock;
+    props.laneWidth = BACKEND_LANE_WIDTH;
+    props.cooperativeGridLimit = workerCount();
+    return props;
+}
+
+struct DeviceSnapshot {
+    std::vector<backend_device_properties> devices;
+};
+
+struct DevicePublication {
+    std::atomic<const DeviceSnapshot*> current;
+    std::once_flag first;
+    std::mutex lock;                                // serializes refreshes
+    std::vector<const DeviceSnapshot*> published;   // every snapshot, kept alive
+
+    DevicePublication() : current(NULL) {}
+};
+
+inline DevicePublication& devicePublication() {
+    static DevicePublication* publication = new DevicePublication();
+    return *publication;
+}
+
+inline const DeviceSnapshot* publishDeviceSnapshot() {
+    DevicePublication& p = devicePublication();
+    const std::vector<Device*>& devices = deviceTable().devices;
+    DeviceSnapshot* snapshot = new DeviceSnapshot();
+    for (size_t i = 0; i < devices.size(); ++i) {
+        snapshot->devices.push_back(readDeviceProperties(*devices[i], devices.size()));
+    }
+    std::lock_guard<std::mutex> guard(p.lock);
+    p.published.push_back(snapshot);
+    p.current.store(snapshot, std::memory_order_release);
+    return snapshot;
+}
+
+// The current snapshot, built by the first caller.
+inline const DeviceSnapshot* deviceSnapshot() {
+    DevicePublication& p = devicePublication();
+    const DeviceSnapshot* snapshot = p.current.load(std::memory_order_acquire);
+    if (snapshot == NULL) {
+        std::call_once(p.first, publishDeviceSnapshot);
+        snapshot = p.current.load(std::memory_order_acquire);
+    }
+    return snapshot;
+}
+
+/*
+ * Blocks of a kernel using `shared` arena bytes that can run at once
+ * without their tiles evicting each other. A worker runs one block at a
+ * time, so a tile that fits in L1d allows one block per worker. Larger
+ * tiles live in L2, and an L2 shared by several CPUs holds only so many.
+ */
+inline unsigned int occupancyLimit(size_t shared) {
+    unsigned int workers = workerCount();
+    const backend_device_properties& device = deviceSnapshot()->devices[currentDeviceIndex()];
+    if (shared <= device.l1dCacheSize) {
+        return workers;
+    }
+    uint64_t domains = (workers + device.l2SharingCpus - 1) / device.l2SharingCpus;
+    uint64_t per_domain = std::max<uint64_t>(1, device.l2CacheSize / shared);
+    return static_cast<unsigned int>(std::min<uint64_t>(workers, domains * per_domain));
+}
+
+/*
+ * Launch-shape model: a block costs its threads plus a fixed dispatch
+ * overhead (arena setup, context, chunk claim) worth about this many
+ * trivial threads, and `active` blocks run at a time, so a grid takes
+ * ceil(grid / active) rounds. Large blocks amortize the overhead; small
+ * ones keep every worker busy when n is small.
+ */
+const uint64_t kBlockOverheadThreads = 64;
+const unsigned int kSuggestMaxBlockSize = 1024;
+
+inline uint64_t launchRounds(uint64_t grid, unsigned int active) {
+    return (grid + active - 1) / active;
+}
+
+class SharedArena {
+public:
+    SharedArena() : raw_(NULL), base_(NULL), capacity_(0) {}
+
+    ~SharedArena() {
+        std::free(raw_);
+    }
+
+    // Returns at least `bytes` of cache-aligned memory, or NULL.
+    char* reserve(size_t bytes) {
+        if (bytes > capacity_) {
+            void* raw = std::malloc(bytes + kSharedMemAlignment);
+            if (raw == NULL) {
+                return NULL;
+            }
+            std::free(raw_);
+            raw_ = raw;
+            base_ = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + kSharedMemAlignment - 1) &
+                                            ~static_cast<uintptr_t>(kSharedMemAlignment - 1));
+            capacity_ = bytes;
+        }
+        return base_;
+    }
+
+private:
+    SharedArena(const SharedArena&);
+    SharedArena& operator=(const SharedArena&);
+
+    void* raw_;
+    char* base_;
+    size_t capacity_;
+};
+
+inline SharedArena& workerArena() {
+    static thread_local SharedArena arena;
+    return arena;
+}
+
+// Runs blocks [first, last) of a launch on behalf of `stream`, x fastest.
+inline void runKernelBlocks(const StreamOp& op, uint64_t first, uint64_t last, Stream* stream,
+                            GridBarrier* barrier = NULL) {
+    backend_kernel_context ctx;
+    ctx.gridDim = op.grid;
+    ctx.blockDim = op.block;
+    ctx.sharedMem = NULL;
+    ctx.dynamicSharedMem = NULL;
+    ctx.gridBarrier = barrier;
+    ctx.workQueue = op.work_queue;
+    ctx.streamError = &stream->error;
+    size_t shared = kernelSharedBytes(op.static_shared, op.shared_mem);
+    if (shared > 0) {
+        // Bounded by kMaxSharedMemPerBlock at launch; an arena that
+        // cannot grow is unrecoverable in a worker
+        char* arena = workerArena().reserve(shared);
+        if (arena == NULL) {
+            std::abort();
+        }
+        ctx.sharedMem = op.static_shared > 0 ? arena : NULL;
+        ctx.dynamicSharedMem = op.shared_mem > 0 ? arena + (shared - op.shared_mem) : NULL;
+    }
+    void** args = op.packed ? reinterpret_cast<void**>(const_cast<unsigned char*>(op.pack)) : op.args;
+    uint64_t plane = static_cast<uint64_t>(op.grid.x) * op.grid.y;
+    for (uint64_t block = first; block < last; ++block) {
+        ctx.blockIdx.x = static_cast<unsigned int>(block % op.grid.x);
+        ctx.blockIdx.y = static_cast<unsigned int>((block / op.grid.x) % op.grid.y);
+        ctx.blockIdx.z = static_cast<unsigned int>(block / plane);
+        op.entry(&ctx, args);
+    }
+}
+
+/*
+ * Lane kernels run the threads of a block as SIMD lanes: a Body's thread
+ * function is inlined into fixed-width loops that the compiler
+ * vectorizes. Threads of a block are independent between barriers, and
+ * lane kernels have no barrier, so the loops carry no dependence.
+ *
+ * Each lane gets an active predicate, which is the lane mask. It is the
+ * constant true in full groups. In the last, partial group it is
+ * t < live, and that group is still the same fixed-width loop. The body
+ * puts its loads and stores under the predicate, which the compiler turns
+ * into masked loads and stores where the target has them (AVX2,
+ * AVX-512); on SSE2 the partial group compiles to scalar code. Branches
+ * in the body that differ between lanes are if-converted into blends.
+ * For floating-point branches GCC only does this with -fno-trapping-math
+ * or on AVX-512.
+ */
+#if defined(__clang__)
+#define BACKEND_DETAIL_LANE_LOOP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define BACKEND_DETAIL_LANE_LOOP _Pragma("GCC ivdep")
+#else
+#define BACKEND_DETAIL_LANE_LOOP
+#endif
+
+template <typename Body, unsigned int Width>
+inline void runLaneGroups(const typename Body::Params& p, const backend_kernel_context* ctx,
+                          unsigned int live) {
+    unsigned int full = live - live % Width;
+    for (unsigned int base = 0; base < full; base += Width) {
+        BACKEND_DETAIL_LANE_LOOP
+        for (unsigned int lane = 0; lane < Width; ++lane) {
+            Body::thread(p, ctx, base + lane, true);
+        }
+    }
+    if (full < live && full <= UINT_MAX - Width) {
+        // The bound check proves full + lane cannot wrap, which the
+        // compiler needs to turn the guarded accesses into masked ones
+        BACKEND_DETAIL_LANE_LOOP
+        for (unsigned int lane = 0; lane < Width; ++lane) {
+            Body::thread(p, ctx, full + lane, full + lane < live);
+        }
+    } else {
+        for (unsigned int t = full; t < live; ++t) {
+            Body::thread(p, ctx, t, true);
+        }
+    }
+}
+
+// A whole block of BlockSize live threads: every trip count is a
+// constant, and only a BlockSize that is not a multiple of Width has a
+// partial group.
+template <typename Body, unsigned int BlockSize, unsigned int Width>
+inline void runLaneBlock(const typename Body::Params& p, const backend_kernel_context* ctx) {
+    const unsigned int full = BlockSize - BlockSize % Width;
+    for (unsigned int base = 0; base < full; base += Width) {
+        BACKEND_DETAIL_LANE_LOOP
+        for (unsigned int lane = 0; lane < Width; ++lane) {
+            Body::thread(p, ctx, base + lane, true);
+        }
+    }
+    if (full < BlockSize) {
+        BACKEND_DETAIL_LANE_LOOP
+        for (unsigned int lane = 0; lane < Width; ++lane) {
+            Body::thread(p, ctx, full + lane, full + lane < BlockSize);
+        }
+    }
+}
+
+#undef BACKEND_DETAIL_LANE_LOOP
+
+/*
+ * Typed launches. The kernel pointer and its arguments are stored by value
+ * in one aligned pack inside the stream op; a trampoline instantiated for
+ * the kernel's parameter types calls the kernel with each argument read
+ * at a compile-time offset into the pack.
+ */
+template <size_t... I>
+struct IndexSequence {};
+
+template <size_t N, size_t... I>
+struct MakeIndexSequence : MakeIndexSequence<N - 1, N - 1, I...> {};
+
+template <size_t... I>
+struct MakeIndexSequence<0, I...> {
+    typedef IndexSequence<I...> type;
+};
+
+// Stops a launch argument from taking part in deduction, so it converts
+// to the kernel's parameter type instead.
+template <typename T>
+struct NonDeduced {
+    typedef T type;
+};
+
+template <typename... T>
+struct ArgPack {};
+
+template <typename Head, typename... Tail>
+struct ArgPack<Head, Tail...> {
+    Head head;
+    ArgPack<Tail...> tail;
+};
+
+template <size_t I>
+struct PackGet {
+    template <typename Head, typename... Tail>
+    static auto get(const ArgPack<Head, Tail...>& p) -> decltype(PackGet<I - 1>::get(p.tail)) {
+        return PackGet<I - 1>::get(p.tail);
+    }
+};
+
+template <>
+struct PackGet<0> {
+    template <typename Head, typename... Tail>
+    static const Head& get(const ArgPack<Head, Tail...>& p) {
+        return p.head;
+    }
+};
+
+inline void fillPack(ArgPack<>*) {}
+
+template <typename Head, typename... Tail>
+inline void fillPack(ArgPack<Head, Tail...>* p, Head head, Tail... tail) {
+    p->head = head;
+    fillPack(&p->tail, tail...);
+}
+
+template <typename... Params>
+struct PackedLaunch {
+    void (*kernel)(const backend_kernel_context*, Params...);
+    ArgPack<Params...> args;
+};
+
+template <typename... Params, size_t... I>
+inline void callPacked(const backend_kernel_context* ctx, const PackedLaunch<Params...>& p,
+                       IndexSequence<I...>) {
+    p.kernel(ctx, PackGet<I>::get(p.args)...);
+}
+
+template <typename... Params>
+inline void runPacked(const backend_kernel_context* ctx, void** pack) {
+    const PackedLaunch<Params...>* p = reinterpret_cast<const PackedLaunch<Params...>*>(pack);
+    callPacked(ctx, *p, typename MakeIndexSequence<sizeof...(Params)>::type());
+}
+
+/*
+ * Kernels launched together with backendLaunchKernelBatch: validated as a
+ * group, queued as one stream op and run back to back by the worker that
+ * reaches it, every block inline, so the batch costs one queue entry and
+ * one scheduler pass however many kernels it holds.
+ */
+struct KernelBatch {
+    std::vector<StreamOp> kernels;
+};
+
+inline void runKernelBatch(const KernelBatch& batch, Stream* stream) {
+    for (size_t i = 0; i < batch.kernels.size(); ++i) {
+        const StreamOp& op = batch.kernels[i];
+        runKernelBlocks(op, 0, kernelBlockCount(op), stream);
+    }
+}
+
+// Executes `op` inline for `stream`, the stream it was queued on or the
+// one running its graph.
+inline void executeOp(const StreamOp& op, Stream* stream) {
+    switch (op.kind) {
+    case OP_COPY:
+        if (op.staged) {
+            stagedCopy(op.dst, op.src, op.size);
+        } else {
+            std::memmove(op.dst, op.src, op.size);
+        }
+        break;
+    case OP_MEMSET:
+        std::memset(op.dst, op.value, op.size);
+        break;
+    case OP_RECORD_EVENT:
+        completeEvent(op.event, op.seq);
+        break;
+    case OP_KERNEL:
+        runKernelBlocks(op, 0, kernelBlockCount(op), stream);
+        break;
+    case OP_WAIT_EVENT:
+    case OP_HOST_CALLBACK:
+    case OP_GRAPH:
+        // Resolved at the stream head by nextRunnableOp
+        break;
+    case OP_CONDITIONAL:
+        // Resolved by runGraphNode
+        break;
+    case OP_KERNEL_BATCH:
+        runKernelBatch(*op.batch, stream);
+        break;
+    case OP_ATTACH_MEM:
+        attachManaged(op, stream);
+        break;
+    case OP_WRITE_VALUE:
+        writeValue(op);
+        break;
+    case OP_WAIT_VALUE:
+        // Resolved at the stream head by nextRunnableOp
+        break;
+    }
+}
+
+/*
+ * Async errors. Work that fails after its enqueue call has returned (so
+ * far, a kernel calling backendKernelRaiseError) stores its code in the
+ * stream's error word; the first error wins and later work still runs.
+ * The word is sticky until backendStreamSynchronize or backendStreamQuery
+ * reports it, which takes it; callbacks see it as their status. With no
+ * error pending, checking costs one relaxed load of a word that shares
+ * the status word's cache line.
+ */
+inline void raiseStreamError(std::atomic<int>* word, backend_error_t error) {
+    int none = 0;
+    word->compare_exchange_strong(none, error, std::memory_order_release, std::memory_order_relaxed);
+}
+
+inline backend_error_t takeStreamError(Stream* s) {
+    if (s->error.load(std::memory_order_relaxed) == 0) {
+        return BACKEND_SUCCESS;
+    }
+    return s->error.exchange(0, std::memory_order_acquire);
+}
+
+// Called with the stream lock held. Retiring the last outstanding op and
+// clearing `scheduled` happen under the same lock hold, so once a caller
+// has seen the stream idle and taken the lock, no worker references it.
+inline void retireOp(Stream* s) {
+    uint64_t status = s->status.load(std::memory_order_relaxed);
+    s->status.store(makeStatus(statusDone(status) + 1, statusIssued(status)),
+                    std::memory_order_release);
+    s->idle_word.wake();
+}
+
+struct StreamRetired {
+    Stream* stream;
+    uint32_t target;
+    bool operator()() const {
+        return seqReached(statusDone(stream->status.load(std::memory_order_acquire)), target);
+    }
+};
+
+struct EventCompleted {
+    Event* event;
+    uint32_t target;
+    bool operator()() const {
+        return seqReached(statusDone(event->status.load(std::memory_order_acquire)), target);
+    }
+};
+
+/*
+ * Dispatcher task: runs the callbacks handed over by nextRunnableOp in
+ * stream order, retires them, and returns the stream to the run queue if
+ * more work arrived behind them.
+ */
+inline void runCallbackBatch(void* arg) {
+    Stream* s = static_cast<Stream*>(arg);
+    for (size_t i = 0; i < s->callback_batch.size(); ++i) {
+        const StreamOp& op = s->callback_batch[i];
+        op.callback(handlePointer(s->handle), s->error.load(std::memory_order_acquire), op.user_data);
+    }
+    bool more;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        for (size_t i = 0; i < s->callback_batch.size(); ++i) {
+            retireOp(s);
+        }
+        s->callback_batch.clear();
+        more = !s->queue.empty();
+        s->scheduled = more;
+    }
+    if (more) {
+        s->device->workers().submit(drainStream, s);
+    }
+}
+
+const uint32_t kNoNode = 0xFFFFFFFFu;
+
+inline void runGraphNode(void* arg);
+inline void finishGraphRun(GraphRun* run);
+
+// Host callback nodes run on the dispatchers, everything else on the workers.
+inline void submitGraphNode(GraphRun* run, uint32_t index) {
+    if (run->params->ops[index].kind == OP_HOST_CALLBACK) {
+        dispatchers().submit(runGraphNode, &run->tasks[index]);
+    } else {
+        run->stream->device->workers().submit(runGraphNode, &run->tasks[index]);
+    }
+}
+
+// Marks node `index` of `run` finished and releases its successors,
+// submitting all but one that became ready and runs on the same pool as
+// `host` says; that one is returned for the caller to run inline, or
+// kNoNode. Finishes the run when this was its last node, after which
+// `run` must not be touched.
+inline uint32_t completeGraphNode(GraphRun* run, uint32_t index, bool host) {
+    const GraphExec* x = run->exec;
+    const std::vector<StreamOp>& ops = run->params->ops;
+    uint32_t next = kNoNode;
+    for (uint32_t i = x->succ_begin[index]; i < x->succ_begin[index + 1]; ++i) {
+        uint32_t succ = x->successors[i];
+        if (run->pending[succ].fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            continue;
+        }
+        if (next == kNoNode && (ops[succ].kind == OP_HOST_CALLBACK) == host) {
+            next = succ;
+        } else {
+            submitGraphNode(run, succ);
+        }
+    }
+    if (run->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finishGraphRun(run);
+        return kNoNode;
+    }
+    return next;
+}
+
+/*
+ * A kernel launch spread over the workers. Each participant claims chunks
+ * of block indices from `next` until the grid is used up, so fast workers
+ * take over the blocks slow ones have not reached; the last participant
+ * to finish completes the launch for its stream or graph node.
+ */
+struct KernelLaunch {
+    StreamOp op;
+    uint64_t blocks;
+    uint64_t chunk;
+    std::atomic<uint64_t> next;         // first unclaimed block
+    std::atomic<uint32_t> active;       // participants still running
+    Stream* stream;                     // stream launch: resumed when done
+    GraphRun* run;                      // graph node: completed when done
+    uint32_t node;
+    Stream* owner;                      // stream or graph run's stream, for errors
+    GridBarrier barrier;                // cooperative launches only
+
+    explicit KernelLaunch(uint32_t participants) : barrier(participants) {}
+};
+
+const uint64_t kChunksPerParticipant = 8;
+
+// One participant per worker, but never more than there are blocks. A
+// cooperative grid is never larger than the worker count.
+inline uint32_t kernelParticipants(const StreamOp& op) {
+    uint64_t blocks = kernelBlockCount(op);
+    uint32_t count = workerCount();
+    return blocks < count ? static_cast<uint32_t>(blocks) : count;
+}
+
+// Whether a kernel op runs through startKernelLaunch rather than inline on
+// the worker draining its stream. Cooperative launches always do, even
+// with one block: a persistent kernel blocks in backendWorkQueuePop until
+// its queue closes, which only the cooperative pool may do.
+inline bool launchesOffStream(const StreamOp& op) {
+    return op.kind == OP_KERNEL && (op.cooperative || kernelParticipants(op) > 1);
+}
+
+// Retires the op a stream was parked on while it ran elsewhere and
+// returns the stream to the run queue if work queued up behind it.
+inline void resumeStream(Stream* s) {
+    bool more;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        retireOp(s);
+        more = !s->queue.empty();
+        s->scheduled = more;
+    }
+    if (more) {
+        s->device->workers().submit(drainStream, s);
+    }
+}
+
+inline void finishKernelLaunch(KernelLaunch* k) {
+    Stream* s = k->stream;
+    GraphRun* run = k->run;
+    uint32_t node = k->node;
+    delete k;
+    if (s != NULL) {
+        resumeStream(s);
+        return;
+    }
+    uint32_t next = completeGraphNode(run, node, false);
+    if (next != kNoNode) {
+        submitGraphNode(run, next);
+    }
+}
+
+inline void runKernelShare(void* arg) {
+    KernelLaunch* k = static_cast<KernelLaunch*>(arg);
+    for (;;) {
+        uint64_t first = k->next.fetch_add(k->chunk, std::memory_order_relaxed);
+        if (first >= k->blocks) {
+            break;
+        }
+        runKernelBlocks(k->op, first, std::min(first + k->chunk, k->blocks), k->owner);
+    }
+    if (k->active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finishKernelLaunch(k);
+    }
+}
+
+// A cooperative participant runs exactly one block, so a block never
+// waits at a barrier for a block queued behind it on the same thread.
+inline void runCooperativeShare(void* arg) {
+    KernelLaunch* k = static_cast<KernelLaunch*>(arg);
+    uint64_t block = k->next.fetch_add(1, std::memory_order_relaxed);
+    runKernelBlocks(k->op, block, block + 1, k->owner, &k->barrier);
+    if (k->active.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        finishKernelLaunch(k);
+    }
+}
+
+// Hands `op` to `participants` workers on behalf of the parked stream `s`
+// or of node `node` of `run`.
+inline void startKernelLaunch(const StreamOp& op, uint32_t participants, Stream* s,
+                              GraphRun* run, uint32_t node) {
+    KernelLaunch* k = new KernelLaunch(participants);
+    k->op = op;
+    k->blocks = kernelBlockCount(op);
+    k->chunk = std::max<uint64_t>(1, k->blocks / (participants * kChunksPerParticipant));
+    k->next.store(0, std::memory_order_relaxed);
+    k->active.store(participants, std::memory_order_relaxed);
+    k->stream = s;
+    k->run = run;
+    k->node = node;
+    k->owner = s != NULL ? s : run->stream;
+    Device* device = k->owner->device;
+    if (op.cooperative) {
+        device->cooperativeWorkers().submitBatch(runCooperativeShare, k, participants);
+        return;
+    }
+    for (uint32_t i = 0; i < participants; ++i) {
+        device->workers().submit(runKernelShare, k);
+    }
+}
+
+// Takes a spare run of `x` (or allocates one) and points it at `p` and
+// `s`. The caller starts it with beginGraphRun.
+inline GraphRun* prepareGraphRun(GraphExec* x, GraphParams* p, Stream* s) {
+    uint32_t count = static_cast<uint32_t>(x->indegree.size());
+    GraphRun* run = x->spare_run.exchange(NULL, std::memory_order_acquire);
+    if (run == NULL) {
+        run = new GraphRun();
+    }
+    if (run->capacity < count) {
+        run->pending.reset(new std::atomic<uint32_t>[count]);
+        run->capacity = count;
+    }
+    run->exec = x;
+    run->params = p;
+    run->stream = s;
+    run->parent = NULL;
+    run->tasks.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        run->tasks[i].run = run;
+        run->tasks[i].index = i;
+    }
+    return run;
+}
+
+// Resets the run's counters and releases its roots. Also restarts a
+// finished body run for the next loop iteration.
+inline void beginGraphRun(GraphRun* run) {
+    const GraphExec* x = run->exec;
+    uint32_t count = static_cast<uint32_t>(x->indegree.size());
+    for (uint32_t i = 0; i < count; ++i) {
+        run->pending[i].store(x->indegree[i], std::memory_order_relaxed);
+    }
+    run->remaining.store(count, std::memory_order_relaxed);
+    for (size_t i = 0; i < x->roots.size(); ++i) {
+        submitGraphNode(run, x->roots[i]);
+    }
+}
+
+// Conditional node reached: if its value is non-zero, starts a run of the
+// body on the workers and returns true; the node completes when the body
+// run ends for good (finishGraphRun). Returns false if the body is skipped.
+inline bool startConditional(GraphRun* run, uint32_t index) {
+    const StreamOp& op = run->params->ops[index];
+    GraphExec* body = op.graph;
+    if (op.cond->value == 0 || body->indegree.empty()) {
+        return false;
+    }
+    GraphParams* p;
+    {
+        std::lock_guard<std::mutex> guard(body->lock);
+        p = body->params;
+        p->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    GraphRun* child = prepareGraphRun(body, p, run->stream);
+    child->parent = run;
+    child->parent_node = index;
+    beginGraphRun(child);
+    return true;
+}
+
+/*
+ * Worker task: executes one graph node and releases its successors. One
+ * successor that became ready and runs on the same pool is executed
+ * inline instead of submitted, so a dependency chain costs no wakeups.
+ */
+inline void runGraphNode(void* arg) {
+    NodeTask* task = static_cast<NodeTask*>(arg);
+    GraphRun* run = task->run;
+    const std::vector<StreamOp>& ops = run->params->ops;
+    uint32_t index = task->index;
+    do {
+        const StreamOp& op = ops[index];
+        bool host = op.kind == OP_HOST_CALLBACK;
+        if (host) {
+            op.callback(handlePointer(run->stream->handle),
+                        run->stream->error.load(std::memory_order_acquire), op.user_data);
+        } else if (op.kind == OP_CONDITIONAL) {
+            if (startConditional(run, index)) {
+                return;
+            }
+        } else if (launchesOffStream(op)) {
+            startKernelLaunch(op, kernelParticipants(op), NULL, run, index);
+            return;
+        } else {
+            executeOp(op, run->stream);
+        }
+        index = completeGraphNode(run, index, host);
+    } while (index != kNoNode);
+}
+
+// Starts a launch of `x` with parameters `p` on behalf of the parked
+// stream `s`. Returns false for an empty graph, which the caller retires
+// inline. Called with the stream lock held.
+inline bool startGraphRun(GraphExec* x, GraphParams* p, Stream* s) {
+    if (x->indegree.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < x->conditionals.size(); ++i) {
+        GraphConditional* c = x->conditionals[i];
+        if (c->flags & BACKEND_GRAPH_COND_ASSIGN_DEFAULT) {
+            c->value = c->default_value;
+        }
+    }
+    beginGraphRun(prepareGraphRun(x, p, s));
+    return true;
+}
+
+// A body run ended. A while loop whose value is still set runs the body
+// again on the same counters; otherwise the conditional node completes.
+inline void finishBodyRun(GraphRun* run) {
+    GraphRun* parent = run->parent;
+    uint32_t node = run->parent_node;
+    const StreamOp& op = parent->params->ops[node];
+    if (op.cond_type == BACKEND_GRAPH_COND_WHILE && op.cond->value != 0) {
+        beginGraphRun(run);
+        return;
+    }
+    GraphExec* x = run->exec;
+    GraphParams* p = run->params;
+    delete x->spare_run.exchange(run, std::memory_order_acq_rel);
+    releaseGraphParams(p);
+    uint32_t next = completeGraphNode(parent, node, false);
+    if (next != kNoNode) {
+        submitGraphNode(parent, next);
+    }
+}
+
+// Last node of a launch finished: retire the launch op and return the
+// stream to the run queue if work queued up behind it.
+inline void finishGraphRun(GraphRun* run) {
+    if (run->parent != NULL) {
+        finishBodyRun(run);
+        return;
+    }
+    Stream* s = run->stream;
+    GraphExec* x = run->exec;
+    GraphParams* p = run->params;
+    delete x->spare_run.exchange(run, std::memory_order_acq_rel);
+    releaseGraphParams(p);
+    releaseGraphExec(x);
+    resumeStream(s);
+}
+
+// Pops the next executable op, retiring satisfied waits at the head along
+// the way. Returns false when the stream is empty (it leaves the run
+// queue), its head is parked on an event or a memory word, its head is a
+// run of callbacks now owned by a dispatcher, or its head is a graph
+// launch or a multi-block or cooperative kernel now running on the
+// workers. Called with the stream lock held.
+inline bool nextRunnableOp(Stream* s, StreamOp* op) {
+    for (;;) {
+        if (s->queue.empty()) {
+            s->scheduled = false;
+            return false;
+        }
+        StreamOp& head = s->queue.front();
+        if (head.kind == OP_HOST_CALLBACK) {
+            // One dispatcher wakeup for the whole run of callbacks
+            do {
+                s->callback_batch.push_back(s->queue.front());
+                s->queue.pop_front();
+            } while (!s->queue.empty() && s->queue.front().kind == OP_HOST_CALLBACK);
+            dispatchers().submit(runCallbackBatch, s);
+            return false;
+        }
+        if (head.kind == OP_GRAPH) {
+            GraphExec* x = head.graph;
+            GraphParams* p = head.params;
+            s->queue.pop_front();
+            if (startGraphRun(x, p, s)) {
+                return false;
+            }
+            releaseGraphParams(p);
+            releaseGraphExec(x);
+            retireOp(s);
+            continue;
+        }
+        if (launchesOffStream(head)) {
+            startKernelLaunch(head, kernelParticipants(head), s, NULL, 0);
+            s->queue.pop_front();
+            return false;
+        }
+        if (head.kind == OP_WAIT_VALUE) {
+            if (!parkOnValue(head, s)) {
+                return false;
+            }
+            s->queue.pop_front();
+            retireOp(s);
+            continue;
+        }
+        if (head.kind != OP_WAIT_EVENT) {
+            *op = head;
+            s->queue.pop_front();
+            return true;
+        }
+        if (!parkOnEvent(head.event, head.seq, s)) {
+            return false;
+        }
+        releaseEvent(head.event);
+        s->queue.pop_front();
+        retireOp(s);
+    }
+}
+
+// Puts a stream left in the handoff on the run queue.
+inline void releaseHandoff(DrainHandoff* handoff) {
+    if (handoff->stream != NULL) {
+        handoff->stream->device->workers().submit(drainStream, handoff->stream);
+        handoff->stream = NULL;
+    }
+}
+
+// Takes the stream left in the handoff to drain next, or NULL. With the
+// budget spent it goes on the run queue instead.
+inline Stream* takeHandoff(DrainHandoff* handoff, unsigned int budget) {
+    if (budget == 0) {
+        releaseHandoff(handoff);
+        return NULL;
+    }
+    Stream* next = handoff->stream;
+    handoff->stream = NULL;
+    return next;
+}
+
+// Executes `s`'s runnable operations while `budget` lasts. Returns a
+// stream its value writes woke for the caller to drain next, or NULL.
+inline Stream* drainOps(Stream* s, DrainHandoff* handoff, unsigned int* budget) {
+    StreamOp op;
+    bool more;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        more = nextRunnableOp(s, &op);
+    }
+    while (more) {
+        executeOp(op, s);
+        if (op.event != NULL) {
+            releaseEvent(op.event);
+        }
+        delete op.batch;
+        --*budget;
+        {
+            std::lock_guard<std::mutex> guard(s->lock);
+            retireOp(s);
+            if (*budget == 0 && !s->queue.empty()) {
+                break;
+            }
+            more = nextRunnableOp(s, &op);
+        }
+        if (more) {
+            // `s` keeps the worker; whatever it woke is run elsewhere
+            releaseHandoff(handoff);
+        }
+    }
+    if (more) {
+        // Budget spent: go to the back of the run queue
+        s->device->workers().submit(drainStream, s);
+    }
+    return takeHandoff(handoff, *budget);
+}
+
+/*
+ * Run-queue task: executes a stream's operations in order until the queue
+ * is empty, the head parks on an incomplete event or an unmet value wait
+ * (the stream stays scheduled and completeEvent or the writer resubmits
+ * it), or the drain budget runs out. A stream handed off by a value write
+ * is drained next on the same budget.
+ */
+inline void drainStream(void* arg) {
+    Stream* s = static_cast<Stream*>(arg);
+    DrainHandoff handoff = { NULL, NULL };
+    drainHandoff() = &handoff;
+    unsigned int budget = kDrainBudget;
+    while (s != NULL) {
+        handoff.device = s->device;
+        s = drainOps(s, &handoff, &budget);
+    }
+    drainHandoff() = NULL;
+}
+
+/*
+ * Stream capture. While a stream captures, enqueueOp diverts its ops here
+ * and they become graph nodes depending on the stream's capture tail.
+ * Records and waits carry no node: a record remembers the tail on the
+ * event, and a wait on such an event merges that tail into the waiting
+ * stream's, or joins a non-capturing stream to the capture (fork/join).
+ * Called with the stream lock held.
+ */
+inline void mergeCaptureDeps(std::vector<uint32_t>* tail, const std::vector<uint32_t>& deps) {
+    for (size_t i = 0; i < deps.size(); ++i) {
+        if (std::find(tail->begin(), tail->end(), deps[i]) == tail->end()) {
+            tail->push_back(deps[i]);
+        }
+    }
+}
+
+// Appends `node` after the stream's capture tail; the graph also takes a
+// reference on each conditional in `conds` the node uses.
+inline void appendCaptureNode(Stream* s, GraphNode* node, const std::vector<GraphConditional*>& conds) {
+    Graph* g = s->capture;
+    node->deps = s->capture_tail;
+    std::lock_guard<std::mutex> graph_guard(g->lock);
+    s->capture_tail.assign(1, static_cast<uint32_t>(g->nodes.size()));
+    g->nodes.push_back(*node);
+    retainConditionals(&g->conditionals, conds);
+}
+
+inline backend_error_t captureOp(Stream* s, const StreamOp& op) {
+    Graph* g = s->capture;
+    switch (op.kind) {
+    case OP_RECORD_EVENT: {
+        std::lock_guard<std::mutex> event_guard(op.event->lock);
+        op.event->capture_graph = g;
+        op.event->capture_deps = s->capture_tail;
+        op.event->refs.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> graph_guard(g->lock);
+        g->captured_events.push_back(op.event);
+        return BACKEND_SUCCESS;
+    }
+    case OP_WAIT_EVENT: {
+        std::lock_guard<std::mutex> event_guard(op.event->lock);
+        if (op.event->capture_graph == g) {
+            mergeCaptureDeps(&s->capture_tail, op.event->capture_deps);
+            return BACKEND_SUCCESS;
+        }
+        if (statusIdle(op.event->status.load(std::memory_order_relaxed))) {
+            return BACKEND_SUCCESS;
+        }
+        // Work outside the graph cannot be waited on from inside it
+        std::lock_guard<std::mutex> graph_guard(g->lock);
+        g->invalidated = true;
+        return BACKEND_ERROR_CAPTURE_INVALIDATED;
+    }
+    case OP_GRAPH:
+    case OP_ATTACH_MEM:
+    case OP_WAIT_VALUE:
+        return BACKEND_ERROR_INVALID_VALUE;
+    case OP_KERNEL_BATCH: {
+        // Captured as a chain of ordinary kernel nodes
+        for (size_t i = 0; i < op.batch->kernels.size(); ++i) {
+            GraphNode node;
+            node.op = op.batch->kernels[i];
+            appendCaptureNode(s, &node, std::vector<GraphConditional*>());
+        }
+        delete op.batch;
+        return BACKEND_SUCCESS;
+    }
+    default: {
+        GraphNode node;
+        node.op = op;
+        appendCaptureNode(s, &node, std::vector<GraphConditional*>());
+        return BACKEND_SUCCESS;
+    }
+    }
+}
+
+// Assigns the record its sequence and takes the op's event reference.
+inline void issueRecord(StreamOp* op) {
+    Event* e = op->event;
+    std::lock_guard<std::mutex> guard(e->lock);
+    uint64_t status = e->status.load(std::memory_order_relaxed);
+    op->seq = statusIssued(status) + 1;
+    e->status.store(makeStatus(statusDone(status), op->seq), std::memory_order_release);
+    e->capture_graph = NULL;
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Snapshots the event's latest record for a wait. Returns false if there
+// is nothing to queue: the record already completed, or it was captured
+// and the stream has joined that capture instead.
+inline bool issueWait(Stream* s, StreamOp* op) {
+    Event* e = op->event;
+    std::lock_guard<std::mutex> guard(e->lock);
+    if (e->capture_graph != NULL) {
+        Graph* g = e->capture_graph;
+        std::lock_guard<std::mutex> graph_guard(g->lock);
+        if (g->capturing) {
+            g->members.push_back(s);
+            s->capture = g;
+            s->capture_tail = e->capture_deps;
+            return false;
+        }
+    }
+    uint64_t status = e->status.load(std::memory_order_relaxed);
+    if (statusIdle(status)) {
+        return false;
+    }
+    op->seq = statusIssued(status);
+    e->refs.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+inline backend_error_t enqueueOp(Stream* s, StreamOp op) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->capture != NULL) {
+            return captureOp(s, op);
+        }
+        if (op.kind == OP_RECORD_EVENT) {
+            issueRecord(&op);
+        } else if (op.kind == OP_WAIT_EVENT && !issueWait(s, &op)) {
+            return BACKEND_SUCCESS;
+        }
+        s->queue.push_back(op);
+        uint64_t status = s->status.load(std::memory_order_relaxed);
+        s->status.store(makeStatus(statusDone(status), statusIssued(status) + 1),
+                        std::memory_order_release);
+        wake = !s->scheduled;
+        s->scheduled = true;
+    }
+    if (wake) {
+        s->device->workers().submit(drainStream, s);
+    }
+    return BACKEND_SUCCESS;
+}
+
+inline StreamOp makeOp(OpKind kind) {
+    StreamOp op;
+    std::memset(&op, 0, sizeof(op));
+    op.kind = kind;
+    return op;
+}
+
+/*
+ * Graph optimizer, run once per instantiation:
+ *   1. fuseGraphChains merges a copy or fill into its sole predecessor when
+ *      that predecessor has no other successor and the two ranges are
+ *      contiguous, so one memmove/memset replaces a chain of them;
+ *   2. reduceGraphEdges drops dependencies already implied through another
+ *      dependency, so launches do fewer counter updates;
+ *   3. orderGraphCriticalPath renumbers nodes so that roots and successors
+ *      are released longest-remaining-path first.
+ * Every pass keeps the invariant that deps point to earlier nodes.
+ */
+inline bool rangesOverlap(const void* a, const void* b, size_t size) {
+    const char* pa = static_cast<const char*>(a);
+    const char* pb = static_cast<const char*>(b);
+    return pa < pb + size && pb < pa + size;
+}
+
+// Merges `next` into `first` if running them as one op is equivalent to
+// running them in order.
+inline bool fuseOps(StreamOp* first, const StreamOp& next) {
+    if (first->kind == OP_COPY && next.kind == OP_COPY) {
+        char* dst = static_cast<char*>(first->dst);
+        const char* src = static_cast<const char*>(first->src);
+        size_t size = first->size + next.size;
+        // One memmove equals two in sequence only if the halves cannot
+        // observe each other's writes
+        if (next.dst != dst + first->size || next.src != src + first->size ||
+            rangesOverlap(dst, src, size)) {
+            return false;
+        }
+        first->size = size;
+        return true;
+    }
+    if (first->kind == OP_MEMSET && next.kind == OP_MEMSET &&
+        static_cast<unsigned char>(first->value) == static_cast<unsigned char>(next.value)) {
+        char* dst = static_cast<char*>(first->dst);
+        if (next.dst == dst + first->size) {
+            first->size += next.size;
+            return true;
+        }
+        if (static_cast<char*>(next.dst) + next.size == dst) {
+            first->dst = next.dst;
+            first->size += next.size;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void fuseGraphChains(std::vector<GraphNode>* nodes) {
+    size_t count = nodes->size();
+    std::vector<uint32_t> owner(count);      // node a fused node now lives in
+    std::vector<uint32_t> out_degree(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        owner[i] = static_cast<uint32_t>(i);
+        const std::vector<uint32_t>& deps = (*nodes)[i].deps;
+        for (size_t d = 0; d < deps.size(); ++d) {
+            ++out_degree[deps[d]];
+        }
+    }
+    // Owners always precede the nodes they absorb, so one forward pass
+    // sees every chain link with its predecessor already resolved
+    for (size_t i = 0; i < count; ++i) {
+        GraphNode& node = (*nodes)[i];
+        if (node.deps.size() != 1) {
+            continue;
+        }
+        uint32_t pred = owner[node.deps[0]];
+        if (out_degree[pred] == 1 && fuseOps(&(*nodes)[pred].op, node.op)) {
+            (*nodes)[pred].sources.push_back(static_cast<uint32_t>(i));
+            owner[i] = pred;
+            out_degree[pred] = out_degree[i];
+        }
+    }
+    std::vector<uint32_t> remap(count);
+    std::vector<GraphNode> fused;
+    fused.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (owner[i] != i) {
+            remap[i] = remap[owner[i]];
+            continue;
+        }
+        remap[i] = static_cast<uint32_t>(fused.size());
+        GraphNode node;
+        node.op = (*nodes)[i].op;
+        node.sources.swap((*nodes)[i].sources);
+        node.body.swap((*nodes)[i].body);
+        const std::vector<uint32_t>& deps = (*nodes)[i].deps;
+        for (size_t d = 0; d < deps.size(); ++d) {
+            uint32_t dep = remap[deps[d]];
+            if (std::find(node.deps.begin(), node.deps.end(), dep) == node.deps.end()) {
+                node.deps.push_back(dep);
+            }
+        }
+        fused.push_back(node);
+    }
+    nodes->swap(fused);
+}
+
+/*
+ * A dependency is redundant if another dependency already reaches it.
+ * Visiting deps latest-first, each kept dep marks its ancestors; the walk
+ * never descends below the earliest dep, since nothing there can be one.
+ */
+inline void reduceGraphEdges(std::vector<GraphNode>* nodes) {
+    size_t count = nodes->size();
+    std::vector<uint32_t> mark(count, 0);
+    std::vector<uint32_t> stack;
+    std::vector<uint32_t> kept;
+    for (size_t i = 0; i < count; ++i) {
+        std::vector<uint32_t>& deps = (*nodes)[i].deps;
+        if (deps.size() < 2) {
+            continue;
+        }
+        uint32_t stamp = static_cast<uint32_t>(i) + 1;
+        std::sort(deps.begin(), deps.end());
+        uint32_t floor = deps.front();
+        kept.clear();
+        for (size_t d = deps.size(); d-- > 0; ) {
+            uint32_t dep = deps[d];
+            if (mark[dep] == stamp) {
+                continue;
+            }
+            kept.push_back(dep);
+            stack.push_back(dep);
+            while (!stack.empty()) {
+                const std::vector<uint32_t>& up = (*nodes)[stack.back()].deps;
+                stack.pop_back();
+                for (size_t u = 0; u < up.size(); ++u) {
+                    if (up[u] >= floor && mark[up[u]] != stamp) {
+                        mark[up[u]] = stamp;
+                        stack.push_back(up[u]);
+                    }
+                }
+            }
+        }
+        deps.assign(kept.rbegin(), kept.rend());
+    }
+}
+
+// Rough relative cost of a node, used only to rank paths.
+inline uint64_t estimateOpCost(const StreamOp& op) {
+    switch (op.kind) {
+    case OP_COPY:
+    case OP_MEMSET:
+        return 1 + op.size / 4096;
+    case OP_KERNEL:
+        return 1 + (static_cast<uint64_t>(op.grid.x) * op.grid.y * op.grid.z *
+                    op.block.x * op.block.y * op.block.z) / 1024;
+    default:
+        return 1;
+    }
+}
+
+struct CriticalPathFirst {
+    const std::vector<uint64_t>* path;
+    bool operator()(uint32_t a, uint32_t b) const {
+        // Max-heap on remaining path; earlier capture order breaks ties
+        if ((*path)[a] != (*path)[b]) {
+            return (*path)[a] < (*path)[b];
+        }
+        return a > b;
+    }
+};
+
+inline void orderGraphCriticalPath(std::vector<GraphNode>* nodes) {
+    size_t count = nodes->size();
+    std::vector<std::vector<uint32_t> > succs(count);
+    std::vector<uint32_t> indegree(count);
+    for (size_t i = 0; i < count; ++i) {
+        const std::vector<uint32_t>& deps = (*nodes)[i].deps;
+        indegree[i] = static_cast<uint32_t>(deps.size());
+        for (size_t d = 0; d < deps.size(); ++d) {
+            succs[deps[d]].push_back(static_cast<uint32_t>(i));
+        }
+    }
+    // Longest cost-weighted path from each node to a sink
+    std::vector<uint64_t> path(count);
+    for (size_t i = count; i-- > 0; ) {
+        uint64_t tail = 0;
+        for (size_t k = 0; k < succs[i].size(); ++k) {
+            tail = std::max(tail, path[succs[i][k]]);
+        }
+        const GraphNode& node = (*nodes)[i];
+        uint64_t cost = estimateOpCost(node.op);
+        if (node.body) {
+            // At least one pass over the body
+            cost += node.body->nodes.size();
+        }
+        path[i] = cost + tail;
+    }
+    // List schedule: always emit the ready node with the longest path
+    CriticalPathFirst before = { &path };
+    std::vector<uint32_t> ready;
+    for (size_t i = 0; i < count; ++i) {
+        if (indegree[i] == 0) {
+            ready.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    std::make_heap(ready.begin(), ready.end(), before);
+    std::vector<uint32_t> remap(count);
+    std::vector<GraphNode> ordered;
+    ordered.reserve(count);
+    while (!ready.empty()) {
+        std::pop_heap(ready.begin(), ready.end(), before);
+        uint32_t i = ready.back();
+        ready.pop_back();
+        remap[i] = static_cast<uint32_t>(ordered.size());
+        ordered.push_back((*nodes)[i]);
+        for (size_t k = 0; k < succs[i].size(); ++k) {
+            if (--indegree[succs[i][k]] == 0) {
+                ready.push_back(succs[i][k]);
+                std::push_heap(ready.begin(), ready.end(), before);
+            }
+        }
+    }
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        std::vector<uint32_t>& deps = ordered[i].deps;
+        for (size_t d = 0; d < deps.size(); ++d) {
+            deps[d] = remap[deps[d]];
+        }
+    }
+    nodes->swap(ordered);
+}
+
+inline void optimizeGraph(std::vector<GraphNode>* nodes) {
+    for (size_t i = 0; i < nodes->size(); ++i) {
+        (*nodes)[i].sources.assign(1, static_cast<uint32_t>(i));
+    }
+    fuseGraphChains(nodes);
+    reduceGraphEdges(nodes);
+    orderGraphCriticalPath(nodes);
+}
+
+/*
+ * Flattens optimized nodes into the executable form. Node order is launch
+ * priority, and successor lists come out sorted by it, so runGraphNode
+ * continues inline with the most critical successor and submits the rest
+ * in order. `source` is the captured graph the nodes were optimized from.
+ */
+inline void buildGraphExec(GraphExec* x, const std::vector<GraphNode>& source,
+                           const std::vector<GraphNode>& nodes) {
+    uint32_t count = static_cast<uint32_t>(nodes.size());
+    x->params = new GraphParams();
+    x->params->ops.resize(count);
+    x->indegree.assign(count, 0);
+    x->succ_begin.assign(count + 1, 0);
+    x->roots.clear();
+    x->member_begin.assign(1, 0);
+    x->members.clear();
+    for (uint32_t i = 0; i < count; ++i) {
+        const GraphNode& node = nodes[i];
+        x->params->ops[i] = node.op;
+        x->members.insert(x->members.end(), node.sources.begin(), node.sources.end());
+        x->member_begin.push_back(static_cast<uint32_t>(x->members.size()));
+        x->indegree[i] = static_cast<uint32_t>(node.deps.size());
+        if (node.deps.empty()) {
+            x->roots.push_back(i);
+        }
+        for (size_t d = 0; d < node.deps.size(); ++d) {
+            ++x->succ_begin[node.deps[d] + 1];
+        }
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        x->succ_begin[i + 1] += x->succ_begin[i];
+    }
+    x->successors.resize(x->succ_begin[count]);
+    std::vector<uint32_t> fill(x->succ_begin.begin(), x->succ_begin.end() - 1);
+    for (uint32_t i = 0; i < count; ++i) {
+        const GraphNode& node = nodes[i];
+        for (size_t d = 0; d < node.deps.size(); ++d) {
+            x->successors[fill[node.deps[d]]++] = i;
+        }
+    }
+    x->source_kinds.resize(source.size());
+    x->source_dep_begin.assign(1, 0);
+    x->source_deps.clear();
+    for (size_t i = 0; i < source.size(); ++i) {
+        x->source_kinds[i] = static_cast<unsigned char>(source[i].op.kind);
+        x->source_deps.insert(x->source_deps.end(), source[i].deps.begin(), source[i].deps.end());
+        x->source_dep_begin.push_back(static_cast<uint32_t>(x->source_deps.size()));
+    }
+}
+
+// True if `source` has the node kinds and dependencies the exec was
+// instantiated from; only node parameters may differ.
+inline bool graphSourceMatches(const GraphExec* x, const std::vector<GraphNode>& source) {
+    if (source.size() != x->source_kinds.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < source.size(); ++i) {
+        const std::vector<uint32_t>& deps = source[i].deps;
+        uint32_t begin = x->source_dep_begin[i];
+        if (source[i].op.kind != x->source_kinds[i] ||
+            deps.size() != x->source_dep_begin[i + 1] - begin ||
+            !std::equal(deps.begin(), deps.end(), x->source_deps.begin() + begin)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rebuilds the exec's launch-order parameters from `source`, refusing
+// parameters that would undo a fusion the topology relies on.
+inline bool composeGraphParams(const GraphExec* x, const std::vector<GraphNode>& source,
+                               std::vector<StreamOp>* ops) {
+    size_t count = x->indegree.size();
+    ops->resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t begin = x->member_begin[i];
+        StreamOp& op = (*ops)[i];
+        op = source[x->members[begin]].op;
+        for (uint32_t m = begin + 1; m < x->member_begin[i + 1]; ++m) {
+            if (!fuseOps(&op, source[x->members[m]].op)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Optimizes and flattens `source`, then instantiates the body of every
+ * conditional node the same way, as an exec owned by this one. Returns a
+ * referenced exec, or NULL if the pool ran out.
+ */
+inline GraphExec* instantiateNodes(const std::vector<GraphNode>& source) {
+    std::vector<GraphNode> optimized(source);
+    optimizeGraph(&optimized);
+    GraphExec* x = graphExecPool().acquire();
+    if (x == NULL) {
+        return NULL;
+    }
+    buildGraphExec(x, source, optimized);
+    x->refs.store(1, std::memory_order_relaxed);
+    x->bodies.assign(optimized.size(), NULL);
+    for (size_t i = 0; i < optimized.size(); ++i) {
+        if (optimized[i].op.kind != OP_CONDITIONAL) {
+            continue;
+        }
+        GraphExec* body = instantiateNodes(optimized[i].body->nodes);
+        if (body == NULL) {
+            graphExecPool().retire(x);
+            releaseGraphExec(x);
+            return NULL;
+        }
+        x->bodies[i] = body;
+        x->params->ops[i].graph = body;
+    }
+    return x;
+}
+
+struct GraphUpdate {
+    GraphExec* exec;
+    std::vector<StreamOp> ops;
+};
+
+// Appends the new parameters for `x` and every body under it to `plan`.
+// Returns false, leaving nothing installed, if any level's topology or
+// fusions differ, or a conditional node changed its conditional.
+inline bool planGraphUpdate(GraphExec* x, const std::vector<GraphNode>& source,
+                            std::vector<GraphUpdate>* plan) {
+    if (!graphSourceMatches(x, source)) {
+        return false;
+    }
+    size_t slot = plan->size();
+    plan->push_back(GraphUpdate());
+    (*plan)[slot].exec = x;
+    if (!composeGraphParams(x, source, &(*plan)[slot].ops)) {
+        return false;
+    }
+    for (size_t i = 0; i < x->bodies.size(); ++i) {
+        if (x->bodies[i] == NULL) {
+            continue;
+        }
+        const GraphNode& node = source[x->members[x->member_begin[i]]];
+        {
+            std::lock_guard<std::mutex> guard(x->lock);
+            if (x->params->ops[i].cond != node.op.cond) {
+                return false;
+            }
+        }
+        (*plan)[slot].ops[i].graph = x->bodies[i];
+        if (!planGraphUpdate(x->bodies[i], node.body->nodes, plan)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Installs new parameters: patched in place if no launch holds the table,
+// swapped for a new table otherwise.
+inline void installGraphParams(GraphExec* x, std::vector<StreamOp>* ops) {
+    GraphParams* retired = NULL;
+    {
+        std::lock_guard<std::mutex> guard(x->lock);
+        if (x->params->refs.load(std::memory_order_acquire) == 1) {
+            x->params->ops.swap(*ops);
+        } else {
+            retired = x->params;
+            x->params = new GraphParams();
+            x->params->ops.swap(*ops);
+        }
+    }
+    if (retired != NULL) {
+        releaseGraphParams(retired);
+    }
+}
+
+/*
+ * Named symbols for graph files. Kernels are referenced by the name they
+ * were registered under; copy, fill and argument pointers must fall in a
+ * registered memory region and are stored as region name plus offset, so
+ * a restarted process that registers the same names gets working nodes.
+ */
+struct KernelSymbol {
+    const void* func;
+    std::string name;
+};
+
+struct MemorySymbol {
+    std::string name;
+    char* base;
+    size_t size;
+};
+
+struct SymbolTable {
+    std::mutex lock;
+    std::vector<KernelSymbol> kernels;
+    std::vector<MemorySymbol> regions;
+};
+
+inline SymbolTable& symbols() {
+    static SymbolTable* table = new SymbolTable();
+    return *table;
+}
+
+/*
+ * Graph file layout. Every section is an array of fixed-size records at
+ * an 8-byte aligned offset named in the header, so a mapped file is read
+ * in place: loading is bounds checks, symbol lookups and bulk copies.
+ */
+const char kGraphFileMagic[8] = { 'A', 'C', 'D', 'G', 'R', 'P', 'H', '1' };
+const uint32_t kGraphFileVersion = 1;
+const uint32_t kGraphFileByteOrder = 0x01020304u;
+const uint32_t kNoSymbol = 0xFFFFFFFFu;
+
+enum SavedSymbolKind { SYMBOL_KERNEL = 0, SYMBOL_MEMORY = 1 };
+
+struct SavedAddress {
+    uint32_t symbol;                    // kNoSymbol for a NULL pointer
+    uint32_t reserved;
+    uint64_t offset;
+};
+
+struct SavedOp {
+    uint32_t kind;
+    int32_t value;
+    uint64_t size;
+    SavedAddress dst;
+    SavedAddress src;
+    SavedAddress args;
+    uint32_t kernel;
+    uint32_t grid[3];
+    uint32_t block[3];
+    uint32_t flags;                     // SavedOpFlags
+    uint64_t shared_mem;
+};
+
+enum SavedOpFlags { SAVED_OP_COOPERATIVE = 1 };
+
+struct SavedSymbol {
+    uint32_t kind;
+    uint32_t name_size;
+    uint64_t name_offset;               // into the string section
+};
+
+enum GraphFileSection {
+    SECTION_OPS,
+    SECTION_SUCC_BEGIN,
+    SECTION_SUCCESSORS,
+    SECTION_INDEGREE,
+    SECTION_ROOTS,
+    SECTION_SOURCE_KINDS,
+    SECTION_SOURCE_DEP_BEGIN,
+    SECTION_SOURCE_DEPS,
+    SECTION_MEMBER_BEGIN,
+    SECTION_MEMBERS,
+    SECTION_SYMBOLS,
+    SECTION_STRINGS,
+    SECTION_COUNT
+};
+
+struct SavedGraphHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t file_size;
+    uint64_t offset[SECTION_COUNT];
+    uint64_t count[SECTION_COUNT];      // records (bytes for strings)
+};
+
+static_assert(sizeof(SavedOp) % 8 == 0 && sizeof(SavedSymbol) % 8 == 0,
+              "graph file records keep sections 8-byte aligned");
+
+// Collects the symbols a graph references while encoding its nodes.
+class GraphFileWriter {
+public:
+    // Encodes `op`; false if it references something without a name.
+    bool encode(const StreamOp& op, SavedOp* out) {
+        std::memset(out, 0, sizeof(*out));
+        out->kind = static_cast<uint32_t>(op.kind);
+        out->value = op.value;
+        out->size = op.size;
+        out->kernel = kNoSymbol;
+        out->dst.symbol = kNoSymbol;
+        out->src.symbol = kNoSymbol;
+        out->args.symbol = kNoSymbol;
+        switch (op.kind) {
+        case OP_COPY:
+            return address(op.dst, op.size, &out->dst) && address(op.src, op.size, &out->src);
+        case OP_MEMSET:
+            return address(op.dst, op.size, &out->dst);
+        case OP_KERNEL:
+            out->grid[0] = op.grid.x;
+            out->grid[1] = op.grid.y;
+            out->grid[2] = op.grid.z;
+            out->block[0] = op.block.x;
+            out->block[1] = op.block.y;
+            out->block[2] = op.block.z;
+            out->shared_mem = op.shared_mem;
+            out->flags = op.cooperative ? SAVED_OP_COOPERATIVE : 0;
+            // Typed arguments are process-local bytes with no names, and
+            // work queues live only as long as the process
+            return !op.packed && op.work_queue == NULL && kernel(op.func, &out->kernel) &&
+                   (op.args == NULL || address(op.args, sizeof(void*), &out->args));
+        default:
+            // Callbacks and conditional nodes carry process-local state
+            return false;
+        }
+    }
+
+    void appendSymbols(std::vector<SavedSymbol>* records, std::string* strings) const {
+        for (size_t i = 0; i < names_.size(); ++i) {
+            SavedSymbol record;
+            record.kind = kinds_[i];
+            record.name_size = static_cast<uint32_t>(names_[i].size());
+            record.name_offset = strings->size();
+            strings->append(names_[i]);
+            records->push_back(record);
+        }
+    }
+
+private:
+    bool address(const void* pointer, size_t size, SavedAddress* out) {
+        const char* p = static_cast<const char*>(pointer);
+        SymbolTable& table = symbols();
+        std::lock_guard<std::mutex> guard(table.lock);
+        for (size_t i = 0; i < table.regions.size(); ++i) {
+            const MemorySymbol& region = table.regions[i];
+            if (p >= region.base && size <= region.size &&
+                static_cast<size_t>(p - region.base) <= region.size - size) {
+                out->symbol = intern(SYMBOL_MEMORY, region.name);
+                out->offset = static_cast<uint64_t>(p - region.base);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool kernel(const void* func, uint32_t* out) {
+        SymbolTable& table = symbols();
+        std::lock_guard<std::mutex> guard(table.lock);
+        for (size_t i = 0; i < table.kernels.size(); ++i) {
+            if (table.kernels[i].func == func) {
+                *out = intern(SYMBOL_KERNEL, table.kernels[i].name);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t intern(uint32_t kind, const std::string& name) {
+        for (size_t i = 0; i < names_.size(); ++i) {
+            if (kinds_[i] == kind && names_[i] == name) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+        kinds_.push_back(kind);
+        names_.push_back(name);
+        return static_cast<uint32_t>(names_.size() - 1);
+    }
+
+    std::vector<uint32_t> kinds_;
+    std::vector<std::string> names_;
+};
+
+// Lays out header and sections in one buffer, ready to be written.
+class GraphFileBuilder {
+public:
+    GraphFileBuilder() : buffer_(sizeof(SavedGraphHeader), 0) {
+        std::memset(&header_, 0, sizeof(header_));
+        std::memcpy(header_.magic, kGraphFileMagic, sizeof(kGraphFileMagic));
+        header_.version = kGraphFileVersion;
+        header_.byte_order = kGraphFileByteOrder;
+    }
+
+    template <typename T>
+    void section(GraphFileSection id, const T* data, size_t count) {
+        buffer_.resize((buffer_.size() + 7) & ~static_cast<size_t>(7), 0);
+        header_.offset[id] = buffer_.size();
+        header_.count[id] = count;
+        const char* bytes = reinterpret_cast<const char*>(data);
+        buffer_.insert(buffer_.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    const std::vector<char>& finish() {
+        header_.file_size = buffer_.size();
+        std::memcpy(&buffer_[0], &header_, sizeof(header_));
+        return buffer_;
+    }
+
+private:
+    SavedGraphHeader header_;
+    std::vector<char> buffer_;
+};
+
+// Writes to a temporary file and renames it over `path`, so a reader never
+// maps a half-written graph.
+inline bool writeGraphFile(const char* path, const std::vector<char>& bytes) {
+    std::string temporary = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == NULL) {
+        return false;
+    }
+    bool written = std::fwrite(&bytes[0], 1, bytes.size(), file) == bytes.size();
+    if (std::fclose(file) != 0 || !written || std::rename(temporary.c_str(), path) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Read-only view of a graph file: mapped where the platform allows,
+ * otherwise read into memory.
+ */
+class MappedFile {
+public:
+    MappedFile() : data_(NULL), size_(0), mapped_(false) {}
+
+    ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped_) {
+            munmap(const_cast<char*>(data_), size_);
+            return;
+        }
+#endif
+        std::free(const_cast<char*>(data_));
+    }
+
+    bool open(const char* path) {
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            ::close(fd);
+            return false;
+        }
+        void* view = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const char*>(view);
+        size_ = static_cast<size_t>(info.st_size);
+        mapped_ = true;
+        return true;
+#else
+        FILE* file = std::fopen(path, "rb");
+        if (file == NULL) {
+            return false;
+        }
+        std::vector<char> bytes;
+        char chunk[65536];
+        size_t got;
+        while ((got = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            bytes.insert(bytes.end(), chunk, chunk + got);
+        }
+        std::fclose(file);
+        if (bytes.empty()) {
+            return false;
+        }
+        char* copy = static_cast<char*>(std::malloc(bytes.size()));
+        if (copy == NULL) {
+            return false;
+        }
+        std::memcpy(copy, &bytes[0], bytes.size());
+        data_ = copy;
+        size_ = bytes.size();
+        return true;
+#endif
+    }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    const char* data_;
+    size_t size_;
+    bool mapped_;
+};
+
+// Typed, bounds-checked access to the sections of a mapped graph file.
+class GraphFileReader {
+public:
+    explicit GraphFileReader(const MappedFile& file) : file_(file), header_(NULL) {}
+
+    bool validate() {
+        if (file_.size() < sizeof(SavedGraphHeader)) {
+            return false;
+        }
+        header_ = reinterpret_cast<const SavedGraphHeader*>(file_.data());
+        if (std::memcmp(header_->magic, kGraphFileMagic, sizeof(kGraphFileMagic)) != 0 ||
+            header_->version != kGraphFileVersion || header_->byte_order != kGraphFileByteOrder ||
+            header_->file_size != file_.size()) {
+            return false;
+        }
+        static const size_t record_size[SECTION_COUNT] = {
+            sizeof(SavedOp), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t),
+            sizeof(unsigned char), sizeof(uint32_t), sizeof(uint32_t), sizeof(uint32_t),
+            sizeof(uint32_t), sizeof(SavedSymbol), sizeof(char)
+        };
+        for (int i = 0; i < SECTION_COUNT; ++i) {
+            uint64_t offset = header_->offset[i];
+            uint64_t count = header_->count[i];
+            if (offset % 8 != 0 || offset < sizeof(SavedGraphHeader) || offset > file_.size() ||
+                count > (file_.size() - offset) / record_size[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename T>
+    const T* section(GraphFileSection id) const {
+        return reinterpret_cast<const T*>(file_.data() + header_->offset[id]);
+    }
+
+    size_t count(GraphFileSection id) const {
+        return static_cast<size_t>(header_->count[id]);
+    }
+
+    template <typename T>
+    void copy(GraphFileSection id, std::vector<T>* out) const {
+        const T* first = section<T>(id);
+        out->assign(first, first + count(id));
+    }
+
+private:
+    const MappedFile& file_;
+    const SavedGraphHeader* header_;
+};
+
+// True if `begin` is a valid offset table over `total` entries for
+// `rows` rows: starts at zero, never decreases and ends at `total`.
+inline bool offsetTableValid(const std::vector<uint32_t>& begin, size_t rows, size_t total) {
+    if (begin.size() != rows + 1 || begin[0] != 0 || begin[rows] != total) {
+        return false;
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        if (begin[i] > begin[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks that the CSR and provenance tables index only inside themselves.
+inline bool graphTablesConsistent(const GraphExec* x) {
+    uint32_t count = static_cast<uint32_t>(x->indegree.size());
+    size_t sources = x->source_kinds.size();
+    if (!offsetTableValid(x->succ_begin, count, x->successors.size()) ||
+        !offsetTableValid(x->member_begin, count, x->members.size()) ||
+        !offsetTableValid(x->source_dep_begin, sources, x->source_deps.size())) {
+        return false;
+    }
+    // Both node orders are topological: edges only point forward, which
+    // also rules out cycles a launch would never finish
+    std::vector<uint32_t> indegree(count, 0);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (x->member_begin[i] == x->member_begin[i + 1]) {
+            return false;
+        }
+        for (uint32_t k = x->succ_begin[i]; k < x->succ_begin[i + 1]; ++k) {
+            if (x->successors[k] <= i || x->successors[k] >= count) {
+                return false;
+            }
+            ++indegree[x->successors[k]];
+        }
+    }
+    if (indegree != x->indegree) {
+        return false;
+    }
+    for (size_t i = 0; i < sources; ++i) {
+        for (uint32_t d = x->source_dep_begin[i]; d < x->source_dep_begin[i + 1]; ++d) {
+            if (x->source_deps[d] >= i) {
+                return false;
+            }
+        }
+    }
+    // Roots are exactly the nodes without dependencies, ascending
+    size_t root = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (x->indegree[i] != 0) {
+            continue;
+        }
+        if (root == x->roots.size() || x->roots[root] != i) {
+            return false;
+        }
+        ++root;
+    }
+    if (root != x->roots.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < x->members.size(); ++i) {
+        if (x->members[i] >= x->source_kinds.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Resolves the names in a graph file against this process's registrations.
+class GraphFileResolver {
+public:
+    backend_error_t resolve(const GraphFileReader& file) {
+        const SavedSymbol* records = file.section<SavedSymbol>(SECTION_SYMBOLS);
+        const char* strings = file.section<char>(SECTION_STRINGS);
+        size_t string_bytes = file.count(SECTION_STRINGS);
+        SymbolTable& table = symbols();
+        std::lock_guard<std::mutex> guard(table.lock);
+        for (size_t i = 0; i < file.count(SECTION_SYMBOLS); ++i) {
+            const SavedSymbol& record = records[i];
+            if (record.name_offset > string_bytes || record.name_size > string_bytes - record.name_offset) {
+                return BACKEND_ERROR_FILE;
+            }
+            std::string name(strings + record.name_offset, record.name_size);
+            Resolved resolved = { record.kind, NULL, 0 };
+            bool found = false;
+            if (record.kind == SYMBOL_KERNEL) {
+                for (size_t k = 0; k < table.kernels.size() && !found; ++k) {
+                    if (table.kernels[k].name == name) {
+                        resolved.base = static_cast<const char*>(table.kernels[k].func);
+                        found = true;
+                    }
+                }
+            } else if (record.kind == SYMBOL_MEMORY) {
+                for (size_t r = 0; r < table.regions.size() && !found; ++r) {
+                    if (table.regions[r].name == name) {
+                        resolved.base = table.regions[r].base;
+                        resolved.size = table.regions[r].size;
+                        found = true;
+                    }
+                }
+            } else {
+                return BACKEND_ERROR_FILE;
+            }
+            if (!found) {
+                return BACKEND_ERROR_SYMBOL_NOT_FOUND;
+            }
+            resolved_.push_back(resolved);
+        }
+        return BACKEND_SUCCESS;
+    }
+
+    // Decodes a node; false if its ranges no longer fit the regions
+    // registered under its names. Node kinds are checked by the caller.
+    bool decode(const SavedOp& in, StreamOp* op) const {
+        *op = makeOp(static_cast<OpKind>(in.kind));
+        op->value = in.value;
+        op->size = static_cast<size_t>(in.size);
+        const void* dst = NULL;
+        switch (in.kind) {
+        case OP_COPY:
+            if (!address(in.src, in.size, &op->src) || !address(in.dst, in.size, &dst)) {
+                return false;
+            }
+            op->dst = const_cast<void*>(dst);
+            return true;
+        case OP_MEMSET:
+            if (!address(in.dst, in.size, &dst)) {
+                return false;
+            }
+            op->dst = const_cast<void*>(dst);
+            return true;
+        case OP_KERNEL: {
+            if (in.kernel >= resolved_.size() || resolved_[in.kernel].kind != SYMBOL_KERNEL) {
+                return false;
+            }
+            if (in.grid[0] == 0 || in.grid[1] == 0 || in.grid[2] == 0 ||
+                in.block[0] == 0 || in.block[1] == 0 || in.block[2] == 0 ||
+                (in.flags & ~static_cast<uint32_t>(SAVED_OP_COOPERATIVE)) != 0) {
+                return false;
+            }
+            op->cooperative = (in.flags & SAVED_OP_COOPERATIVE) != 0;
+            if (op->cooperative &&
+                static_cast<uint64_t>(in.grid[0]) * in.grid[1] * in.grid[2] > workerCount()) {
+                return false;
+            }
+            op->func = resolved_[in.kernel].base;
+            HostKernel kernel;
+            if (!hostKernels().find(op->func, &kernel) ||
+                kernelSharedBytes(kernel.static_shared, in.shared_mem) > kMaxSharedMemPerBlock) {
+                return false;
+            }
+            op->entry = kernel.entry;
+            op->static_shared = kernel.static_shared;
+            op->grid.x = in.grid[0];
+            op->grid.y = in.grid[1];
+            op->grid.z = in.grid[2];
+            op->block.x = in.block[0];
+            op->block.y = in.block[1];
+            op->block.z = in.block[2];
+            op->shared_mem = static_cast<size_t>(in.shared_mem);
+            if (in.args.symbol == kNoSymbol) {
+                return true;
+            }
+            const void* args = NULL;
+            if (!address(in.args, sizeof(void*), &args)) {
+                return false;
+            }
+            op->args = static_cast<void**>(const_cast<void*>(args));
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+private:
+    struct Resolved {
+        uint32_t kind;
+        const char* base;
+        size_t size;
+    };
+
+    bool address(const SavedAddress& in, uint64_t size, const void** out) const {
+        if (in.symbol >= resolved_.size() || resolved_[in.symbol].kind != SYMBOL_MEMORY) {
+            return false;
+        }
+        const Resolved& region = resolved_[in.symbol];
+        if (size > region.size || in.offset > region.size - size) {
+            return false;
+        }
+        *out = region.base + in.offset;
+        return true;
+    }
+
+    std::vector<Resolved> resolved_;
+};
+
+
+// Validates a launch and fills in its kernel op. A function with no
+// registered host callable is accepted only when `entry` is given.
+inline backend_error_t prepareLaunch(const void* func, backend_host_kernel_t entry, backend_dim3 grid,
+                                     backend_dim3 block, size_t sharedMem, backend_stream_t stream,
+                                     Stream** s, StreamOp* op) {
+    if (func == NULL || stream == NULL ||
+        grid.x == 0 || grid.y == 0 || grid.z == 0 ||
+        block.x == 0 || block.y == 0 || block.z == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *s = lookupStream(stream);
+    if (*s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    HostKernel kernel = { entry, 0 };
+    if (!hostKernels().find(func, &kernel)) {
+        if (entry == NULL) {
+            return BACKEND_ERROR_INVALID_DEVICE_FUNCTION;
+        }
+    } else if (entry != NULL) {
+        kernel.entry = entry;
+    }
+    if (kernelSharedBytes(kernel.static_shared, sharedMem) > kMaxSharedMemPerBlock) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *op = makeOp(OP_KERNEL);
+    op->func = func;
+    op->entry = kernel.entry;
+    op->static_shared = kernel.static_shared;
+    op->grid = grid;
+    op->block = block;
+    op->shared_mem = sharedMem;
+    return BACKEND_SUCCESS;
+}
+
+// Shared by the plain and cooperative launch entry points.
+inline backend_error_t launchKernel(const void* func, backend_dim3 grid, backend_dim3 block,
+                                    void** args, size_t sharedMem, backend_stream_t stream,
+                                    bool cooperative, backend_work_queue_t queue = NULL) {
+    Stream* s;
+    StreamOp op;
+    backend_error_t result = prepareLaunch(func, NULL, grid, block, sharedMem, stream, &s, &op);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    if (cooperative && static_cast<uint64_t>(grid.x) * grid.y * grid.z > workerCount()) {
+        return BACKEND_ERROR_COOPERATIVE_LAUNCH_TOO_LARGE;
+    }
+    op.args = args;
+    op.cooperative = cooperative;
+    op.work_queue = queue;
+    return enqueueOp(s, op);
+}
+
+// Validates every launch of a batch before any is queued, then queues
+// them as one op.
+inline backend_error_t launchKernelBatch(const backend_launch_params* launches, unsigned int count,
+                                         backend_stream_t stream) {
+    if (launches == NULL || count == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    KernelBatch* batch = new KernelBatch();
+    batch->kernels.resize(count);
+    Stream* s = NULL;
+    for (unsigned int i = 0; i < count; ++i) {
+        const backend_launch_params& in = launches[i];
+        backend_error_t result = prepareLaunch(in.func, NULL, in.grid, in.block, in.sharedMem, stream,
+                                               &s, &batch->kernels[i]);
+        if (result != BACKEND_SUCCESS) {
+            delete batch;
+            return result;
+        }
+        batch->kernels[i].args = in.args;
+    }
+    StreamOp op = makeOp(OP_KERNEL_BATCH);
+    op.batch = batch;
+    return enqueueOp(s, op);
+}
+
+// Typed launch: `pack` holds `size` bytes that `entry` decodes.
+inline backend_error_t launchPackedKernel(const void* func, backend_host_kernel_t entry,
+                                          const void* pack, size_t size, backend_dim3 grid,
+                                          backend_dim3 block, size_t sharedMem, backend_stream_t stream) {
+    Stream* s;
+    StreamOp op;
+    backend_error_t result = prepareLaunch(func, entry, grid, block, sharedMem, stream, &s, &op);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    op.packed = true;
+    std::memcpy(op.pack, pack, size);
+    return enqueueOp(s, op);
+}
+
+} // namespace backend_detail
+
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Creates an empty in-order host stream from the stream slab pool, on the calling thread's current device
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendStreamCreate(backend_stream_t* stream, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamCreate(backend_stream_t* stream, unsigned int flags) {
+    if (stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::streamPool().acquire();
+    if (s == NULL) {
+        *stream = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    s->reset(flags, backend_detail::currentDevice());
+    *stream = backend_detail::handlePointer(s->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Blocks until every operation enqueued on the stream before the call has retired, then reports the stream's pending async error, if any
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_STRATEGY: Waits under the stream's wait policy, falling back to the process policy. Reporting an async error takes it, so it is returned once
+ * TARGET_API_REF: backendStreamSynchronize(backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendStreamSynchronize(backend_stream_t stream) {
+    if (stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamRetired done;
+    done.stream = s;
+    done.target = backend_detail::statusIssued(s->status.load(std::memory_order_acquire));
+    backend_detail::waitFor(s->idle_word, done, s->wait_policy.load(std::memory_order_relaxed));
+    return backend_detail::takeStreamError(s);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys a stream once its outstanding work has retired; the handle is invalidated and the slot recycled. Fails while the stream takes part in a capture. An unreported async error is dropped
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendStreamDestroy(backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendStreamDestroy(backend_stream_t stream) {
+    if (stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backendStreamSynchronize(stream);
+    {
+        // The worker that retired the last op may still hold the lock
+        std::lock_guard<std::mutex> guard(s->lock);
+        if (s->capture != NULL) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+    }
+    backend_detail::detachManaged(s);
+    backend_detail::streamPool().retire(s);
+    backend_detail::streamPool().recycle(s);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports the stream's pending async error if there is one, otherwise whether all work enqueued on the stream has retired
+ * AI_DEPENDENCIES: INIT_HOOKS, ERROR_HANDLING
+ * AI_STRATEGY: A relaxed load of the error word and an acquire load of the status word, on one cache line; no lock or syscall. An error is reported as soon as it is raised, before the stream goes idle, and is taken like in backendStreamSynchronize
+ * TARGET_API_REF: backendStreamQuery(backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendStreamQuery(backend_stream_t stream) {
+    if (stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_error_t error = backend_detail::takeStreamError(s);
+    if (error != BACKEND_SUCCESS) {
+        return error;
+    }
+    return backend_detail::statusIdle(s->status.load(std::memory_order_acquire))
+               ? BACKEND_SUCCESS : BACKEND_ERROR_NOT_READY;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Device whose workers run the stream's work, i.e. the one current when it was created
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendStreamGetDevice(backend_stream_t stream, int* device) - backend_api.h
+ */
+inline backend_error_t backendStreamGetDevice(backend_stream_t stream, int* device) {
+    if (stream == NULL || device == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    *device = s->device->index;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Allocates sizeBytes of device memory from the current device's arena
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: Page-granular blocks, bound to the device's NUMA node when it has one and reused from the arena's cache of freed blocks before new ones are mapped. Device memory is ordinary host memory, usable by any stream and by host code. A zero size yields NULL
+ * TARGET_API_REF: backendMalloc(void** ptr, size_t sizeBytes) - backend_api.h
+ */
+inline backend_error_t backendMalloc(void** ptr, size_t sizeBytes) {
+    if (ptr == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *ptr = NULL;
+    if (sizeBytes == 0) {
+        return BACKEND_SUCCESS;
+    }
+    *ptr = backend_detail::currentDevice()->arena.allocate(sizeBytes);
+    return *ptr != NULL ? BACKEND_SUCCESS : BACKEND_ERROR_OUT_OF_MEMORY;
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Returns memory from backendMalloc to the arena of the device it came from, whichever device is current, or unmaps memory from backendMallocManaged
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: The caller must make sure no queued work still uses it. NULL is accepted; a pointer no arena handed out is rejected
+ * TARGET_API_REF: backendFree(void* ptr) - backend_api.h
+ */
+inline backend_error_t backendFree(void* ptr) {
+    if (ptr == NULL) {
+        return BACKEND_SUCCESS;
+    }
+    {
+        backend_detail::ManagedRegistry& registry = backend_detail::managedRegistry();
+        std::unique_lock<std::mutex> guard(registry.lock);
+        std::map<uintptr_t, backend_detail::ManagedBlock>::iterator it =
+            registry.blocks.find(reinterpret_cast<uintptr_t>(ptr));
+        if (it != registry.blocks.end()) {
+            size_t size = it->second.size;
+            registry.blocks.erase(it);
+            guard.unlock();
+#if defined(__unix__) || defined(__APPLE__)
+            munmap(ptr, size);
+#else
+            (void)size;
+            std::free(ptr);
+#endif
+            return BACKEND_SUCCESS;
+        }
+    }
+    const std::vector<backend_detail::Device*>& devices = backend_detail::deviceTable().devices;
+    for (size_t i = 0; i < devices.size(); ++i) {
+        if (devices[i]->arena.release(ptr)) {
+            return BACKEND_SUCCESS;
+        }
+    }
+    return BACKEND_ERROR_INVALID_VALUE;
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Allocates sizeBytes of managed memory, usable by every device and the host and placed by attachment
+ * AI_DEPENDENCIES: INIT_HOOKS, DEVICE_QUERY
+ * AI_PATTERN: UNIFIED_MEMORY_V1
+ * AI_STRATEGY: Its own page-rounded mapping, attached BACKEND_MEM_ATTACH_GLOBAL (interleaved over the devices' NUMA nodes) or BACKEND_MEM_ATTACH_HOST (the same placement; the flag is recorded). Attach it to one stream with backendStreamAttachMemAsync. Freed with backendFree. A zero size yields NULL
+ * TARGET_API_REF: backendMallocManaged(void** ptr, size_t sizeBytes, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendMallocManaged(void** ptr, size_t sizeBytes, unsigned int flags) {
+    if (ptr == NULL || (flags != BACKEND_MEM_ATTACH_GLOBAL && flags != BACKEND_MEM_ATTACH_HOST)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *ptr = NULL;
+    if (sizeBytes == 0) {
+        return BACKEND_SUCCESS;
+    }
+    const size_t page = 4096;
+    size_t size = (sizeBytes + page - 1) & ~(page - 1);
+#if defined(__unix__) || defined(__APPLE__)
+    void* block = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (block == MAP_FAILED) {
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+#else
+    void* block = std::malloc(size);
+    if (block == NULL) {
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+#endif
+    backend_detail::placeManaged(block, size, flags, NULL, false);
+    backend_detail::ManagedBlock managed;
+    managed.size = size;
+    managed.attach = flags;
+    managed.owner = NULL;
+    backend_detail::ManagedRegistry& registry = backend_detail::managedRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.blocks[reinterpret_cast<uintptr_t>(block)] = managed;
+    *ptr = block;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Attaches a managed allocation to the stream (BACKEND_MEM_ATTACH_SINGLE) or back to every device (GLOBAL) or the host (HOST), in stream order
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, MEMORY_TRANSLATION
+ * AI_PATTERN: UNIFIED_MEMORY_V1
+ * AI_STRATEGY: Queued as a stream op. When it runs, a single attachment moves the block's pages to the stream's device node and faults in the rest on its worker, so work behind it starts on resident local pages; global and host attachments interleave the block over the devices' nodes again. Only the attached stream should use single memory until it is re-attached; the host may use it once that stream has synchronized. ptr must be the start of the allocation and length 0 or its size. Cannot be captured
+ * TARGET_API_REF: backendStreamAttachMemAsync(backend_stream_t stream, void* ptr, size_t length, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamAttachMemAsync(backend_stream_t stream, void* ptr, size_t length,
+                                                   unsigned int flags) {
+    if (stream == NULL || ptr == NULL ||
+        (flags != BACKEND_MEM_ATTACH_GLOBAL && flags != BACKEND_MEM_ATTACH_HOST &&
+         flags != BACKEND_MEM_ATTACH_SINGLE)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    {
+        backend_detail::ManagedRegistry& registry = backend_detail::managedRegistry();
+        std::lock_guard<std::mutex> guard(registry.lock);
+        std::map<uintptr_t, backend_detail::ManagedBlock>::iterator it =
+            registry.blocks.find(reinterpret_cast<uintptr_t>(ptr));
+        if (it == registry.blocks.end() || (length != 0 && (length + 4095) / 4096 != it->second.size / 4096)) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_ATTACH_MEM);
+    op.dst = ptr;
+    op.attach = flags;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Whether device can be given direct access to peerDevice's memory
+ * AI_DEPENDENCIES: DEVICE_QUERY
+ * AI_STRATEGY: Host devices share one address space, so any two distinct devices can; a device is not its own peer
+ * TARGET_API_REF: backendDeviceCanAccessPeer(int* canAccessPeer, int device, int peerDevice) - backend_api.h
+ */
+inline backend_error_t backendDeviceCanAccessPeer(int* canAccessPeer, int device, int peerDevice) {
+    if (canAccessPeer == NULL || !backend_detail::validDevice(device) ||
+        !backend_detail::validDevice(peerDevice)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *canAccessPeer = device != peerDevice ? 1 : 0;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Gives the current device direct access to peerDevice's memory; peer copies between the two then skip staging
+ * AI_DEPENDENCIES: DEVICE_QUERY, MEMORY_TRANSLATION
+ * AI_STRATEGY: One bit per peer in the device's atomic peer mask, read by each peer copy as it is issued. flags must be 0. Enabling twice fails with BACKEND_ERROR_PEER_ACCESS_ALREADY_ENABLED
+ * TARGET_API_REF: backendDeviceEnablePeerAccess(int peerDevice, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendDeviceEnablePeerAccess(int peerDevice, unsigned int flags) {
+    int device = backend_detail::currentDeviceIndex();
+    if (flags != 0 || !backend_detail::validDevice(peerDevice) || peerDevice == device) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    uint64_t bit = 1ull << peerDevice;
+    uint64_t before = backend_detail::currentDevice()->peers.fetch_or(bit, std::memory_order_acq_rel);
+    return (before & bit) != 0 ? BACKEND_ERROR_PEER_ACCESS_ALREADY_ENABLED : BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Withdraws the current device's access to peerDevice's memory; later peer copies between them are staged again
+ * AI_DEPENDENCIES: DEVICE_QUERY, MEMORY_TRANSLATION
+ * TARGET_API_REF: backendDeviceDisablePeerAccess(int peerDevice) - backend_api.h
+ */
+inline backend_error_t backendDeviceDisablePeerAccess(int peerDevice) {
+    int device = backend_detail::currentDeviceIndex();
+    if (!backend_detail::validDevice(peerDevice) || peerDevice == device) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    uint64_t bit = 1ull << peerDevice;
+    uint64_t before = backend_detail::currentDevice()->peers.fetch_and(~bit, std::memory_order_acq_rel);
+    return (before & bit) == 0 ? BACKEND_ERROR_PEER_ACCESS_NOT_ENABLED : BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Copies sizeBytes from srcDevice's memory to dstDevice's memory and returns when the copy is done
+ * AI_DEPENDENCIES: DEVICE_QUERY, MEMORY_TRANSLATION
+ * AI_STRATEGY: Both ranges must lie in backendMalloc blocks of the named devices. With peer access enabled between the devices, in either direction, it is one direct memmove; otherwise it is staged through a bounce buffer. Runs on the calling thread, not ordered with any stream
+ * TARGET_API_REF: backendMemcpyPeer(void* dst, int dstDevice, const void* src, int srcDevice, size_t sizeBytes) - backend_api.h
+ */
+inline backend_error_t backendMemcpyPeer(void* dst, int dstDevice, const void* src, int srcDevice,
+                                         size_t sizeBytes) {
+    bool staged;
+    backend_error_t result = backend_detail::checkPeerCopy(dst, dstDevice, src, srcDevice, sizeBytes, &staged);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    if (staged) {
+        backend_detail::stagedCopy(dst, src, sizeBytes);
+    } else {
+        std::memmove(dst, src, sizeBytes);
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: PEER_MEMORY_ACCESS
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Enqueues a copy from srcDevice's memory to dstDevice's memory on a stream of any device
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, MEMORY_TRANSLATION
+ * AI_STRATEGY: Validated like backendMemcpyPeer and queued as an ordinary stream copy, direct or staged as peer access stands when it is issued, so it fuses, captures and saves like any copy (a saved staged copy loads as a direct one)
+ * TARGET_API_REF: backendMemcpyPeerAsync(void* dst, int dstDevice, const void* src, int srcDevice, size_t sizeBytes, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendMemcpyPeerAsync(void* dst, int dstDevice, const void* src, int srcDevice,
+                                              size_t sizeBytes, backend_stream_t stream) {
+    if (stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    bool staged;
+    backend_error_t result = backend_detail::checkPeerCopy(dst, dstDevice, src, srcDevice, sizeBytes, &staged);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_COPY);
+    op.dst = dst;
+    op.src = src;
+    op.size = sizeBytes;
+    op.staged = staged;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Enqueues a stream-ordered copy; all memory is host memory so every kind is a memmove
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendMemcpyAsync(void* dst, const void* src, size_t sizeBytes, backend_memcpy_kind kind, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendMemcpyAsync(void* dst, const void* src, size_t sizeBytes,
+                                          backend_memcpy_kind kind, backend_stream_t stream) {
+    (void)kind;
+    if (dst == NULL || src == NULL || sizeBytes == 0 || stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_COPY);
+    op.dst = dst;
+    op.src = src;
+    op.size = sizeBytes;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: MEMORY_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Enqueues a stream-ordered byte fill
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendMemsetAsync(void* dst, int value, size_t sizeBytes, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendMemsetAsync(void* dst, int value, size_t sizeBytes,
+                                          backend_stream_t stream) {
+    if (dst == NULL || sizeBytes == 0 || stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_MEMSET);
+    op.dst = dst;
+    op.value = value;
+    op.size = sizeBytes;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Enqueues a host callback that runs on the dispatcher pool once prior work in the stream has retired
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: Consecutive callbacks at the stream head go to one dispatcher as a batch; later work in the stream waits for the batch
+ * TARGET_API_REF: backendStreamAddCallback(backend_stream_t stream, backend_stream_callback_t callback, void* userData) - backend_api.h
+ */
+inline backend_error_t backendStreamAddCallback(backend_stream_t stream, backend_stream_callback_t callback,
+                                                void* userData) {
+    if (stream == NULL || callback == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_HOST_CALLBACK);
+    op.callback = callback;
+    op.user_data = userData;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Creates an unrecorded event from the event slab pool; an unrecorded event counts as complete
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendEventCreate(backend_event_t* event, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendEventCreate(backend_event_t* event, unsigned int flags) {
+    if (event == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::eventPool().acquire();
+    if (e == NULL) {
+        *event = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    e->reset(flags);
+    *event = backend_detail::handlePointer(e->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Invalidates the handle at once; queued records and waits keep the slot alive until they retire
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendEventDestroy(backend_event_t event) - backend_api.h
+ */
+inline backend_error_t backendEventDestroy(backend_event_t event) {
+    if (event == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::eventPool().retire(e);
+    backend_detail::releaseEvent(e);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Enqueues a marker that completes the event once all prior work in the stream has retired; during capture it marks the capture point for streamWaitEvent instead
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendEventRecord(backend_event_t event, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendEventRecord(backend_event_t event, backend_stream_t stream) {
+    if (event == NULL || stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_RECORD_EVENT);
+    op.event = e;
+    return backend_detail::enqueueOp(s, op);
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Blocks the calling host thread until the latest record of the event has completed
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_STRATEGY: BLOCKING_SYNC events sleep in the kernel; others use the event or process wait policy
+ * TARGET_API_REF: backendEventSynchronize(backend_event_t event) - backend_api.h
+ */
+inline backend_error_t backendEventSynchronize(backend_event_t event) {
+    if (event == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::EventCompleted done;
+    done.event = e;
+    done.target = backend_detail::statusIssued(e->status.load(std::memory_order_acquire));
+    backend_detail::waitFor(e->done_word, done, e->wait_policy.load(std::memory_order_relaxed));
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports whether the latest record of the event has completed
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_STRATEGY: One acquire load of the event's status word; no lock or syscall
+ * TARGET_API_REF: backendEventQuery(backend_event_t event) - backend_api.h
+ */
+inline backend_error_t backendEventQuery(backend_event_t event) {
+    if (event == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    return backend_detail::statusIdle(e->status.load(std::memory_order_acquire))
+               ? BACKEND_SUCCESS : BACKEND_ERROR_NOT_READY;
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Polls many events at once; results[i] is SUCCESS, NOT_READY or INVALID_HANDLE for events[i]
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_STRATEGY: Prefetches slots a few entries ahead, then one acquire load per event; returns INVALID_HANDLE if any handle failed, else NOT_READY if any event is pending
+ * TARGET_API_REF: backendEventQueryBatch(const backend_event_t* events, size_t count, backend_error_t* results) - backend_api.h
+ */
+inline backend_error_t backendEventQueryBatch(const backend_event_t* events, size_t count,
+                                              backend_error_t* results) {
+    if (count > 0 && (events == NULL || results == NULL)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    const size_t kPrefetchDistance = 8;
+    backend_detail::EventPool& pool = backend_detail::eventPool();
+    for (size_t i = 0; i < count && i < kPrefetchDistance; ++i) {
+        pool.prefetch(events[i]);
+    }
+    bool pending = false;
+    bool invalid = false;
+    for (size_t i = 0; i < count; ++i) {
+        if (i + kPrefetchDistance < count) {
+            pool.prefetch(events[i + kPrefetchDistance]);
+        }
+        backend_detail::Event* e = pool.lookup(events[i]);
+        if (e == NULL) {
+            results[i] = BACKEND_ERROR_INVALID_HANDLE;
+            invalid = true;
+        } else if (backend_detail::statusIdle(e->status.load(std::memory_order_acquire))) {
+            results[i] = BACKEND_SUCCESS;
+        } else {
+            results[i] = BACKEND_ERROR_NOT_READY;
+            pending = true;
+        }
+    }
+    if (invalid) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    return pending ? BACKEND_ERROR_NOT_READY : BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Device-side cross-stream dependency; the stream head parks on the event and the completing worker reschedules it
+ * AI_DEPENDENCIES: EVENT_MANAGEMENT
+ * AI_PATTERN: STREAM_WAIT_EVENT_V2
+ * AI_STRATEGY: Snapshot the event's latest record under the stream lock; skip the op entirely if it already completed, otherwise enqueue a wait that drainStream resolves without blocking a worker. A wait on a record made during capture joins the stream to that capture
+ * TARGET_API_REF: backendStreamWaitEvent(backend_stream_t stream, backend_event_t event) - backend_api.h
+ */
+inline backend_error_t backendStreamWaitEvent(backend_stream_t stream, backend_event_t event) {
+    if (stream == NULL || event == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_WAIT_EVENT);
+    op.event = e;
+    return backend_detail::enqueueOp(s, op);
+}
+
+namespace backend_detail {
+
+inline backend_error_t enqueueValueOp(backend_stream_t stream, OpKind kind, void* ptr, uint64_t value,
+                                      unsigned int compare, bool wide) {
+    size_t width = wide ? sizeof(uint64_t) : sizeof(uint32_t);
+    if (stream == NULL || ptr == NULL || reinterpret_cast<uintptr_t>(ptr) % width != 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    Stream* s = lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    StreamOp op = makeOp(kind);
+    op.dst = ptr;
+    op.word = value;
+    op.compare = compare;
+    op.wide = wide;
+    return enqueueOp(s, op);
+}
+
+} // namespace backend_detail
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Stores value to a 32-bit word once the stream reaches the op, after all earlier work on it has completed
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * AI_STRATEGY: A sequentially consistent store, then the worker reschedules any stream whose value wait on the word now holds; with none parked on the word's bucket that costs one load. ptr must be 4-byte aligned and flags 0. Captures as a graph node
+ * TARGET_API_REF: backendStreamWriteValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamWriteValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value,
+                                                 unsigned int flags) {
+    if (flags != 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    return backend_detail::enqueueValueOp(stream, backend_detail::OP_WRITE_VALUE, ptr, value, 0, false);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: 64-bit form of backendStreamWriteValue32; ptr must be 8-byte aligned
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * TARGET_API_REF: backendStreamWriteValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamWriteValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value,
+                                                 unsigned int flags) {
+    if (flags != 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    return backend_detail::enqueueValueOp(stream, backend_detail::OP_WRITE_VALUE, ptr, value, 0, true);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Holds the stream's later work until a 32-bit word compares against value as flags asks (backend_stream_wait_value_flags)
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * AI_STRATEGY: Resolved at the stream head like an event wait: if the comparison fails the stream parks on the word without holding a worker, and the write that satisfies it reschedules the stream, so nothing polls. A stream-ordered write hands the woken stream straight to its own worker when the writer's stream has nothing runnable, so a ping-pong stays on one worker. Only writes made by backendStreamWriteValue32/64 wake waiters; host code or kernels that store to the word themselves call backendNotifyValue afterwards. ptr must be 4-byte aligned. Cannot be captured
+ * TARGET_API_REF: backendStreamWaitValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamWaitValue32(backend_stream_t stream, uint32_t* ptr, uint32_t value,
+                                                unsigned int flags) {
+    if (flags > BACKEND_STREAM_WAIT_VALUE_AND) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    return backend_detail::enqueueValueOp(stream, backend_detail::OP_WAIT_VALUE, ptr, value, flags, false);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: 64-bit form of backendStreamWaitValue32; ptr must be 8-byte aligned
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * TARGET_API_REF: backendStreamWaitValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendStreamWaitValue64(backend_stream_t stream, uint64_t* ptr, uint64_t value,
+                                                unsigned int flags) {
+    if (flags > BACKEND_STREAM_WAIT_VALUE_AND) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    return backend_detail::enqueueValueOp(stream, backend_detail::OP_WAIT_VALUE, ptr, value, flags, true);
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reschedules streams whose value wait on ptr now holds, after the host or a kernel stored to the word directly
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: STREAM_MEMORY_OPS_V1
+ * AI_STRATEGY: The store must be atomic (e.g. __atomic_store_n) and happen before the call. Safe to call from kernels and callbacks
+ * TARGET_API_REF: backendNotifyValue(void* ptr) - backend_api.h
+ */
+inline backend_error_t backendNotifyValue(void* ptr) {
+    if (ptr == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::wakeValueWaiters(ptr);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Sets the process-wide host wait policy used by objects left at BACKEND_WAIT_DEFAULT
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendSetWaitPolicy(backend_wait_policy policy) - backend_api.h
+ */
+inline backend_error_t backendSetWaitPolicy(backend_wait_policy policy) {
+    if (policy < BACKEND_WAIT_SPIN || policy > BACKEND_WAIT_ADAPTIVE) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::processWaitPolicy().store(policy);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Overrides the host wait policy for synchronizing this stream
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendStreamSetWaitPolicy(backend_stream_t stream, backend_wait_policy policy) - backend_api.h
+ */
+inline backend_error_t backendStreamSetWaitPolicy(backend_stream_t stream, backend_wait_policy policy) {
+    if (stream == NULL || policy < BACKEND_WAIT_DEFAULT || policy > BACKEND_WAIT_ADAPTIVE) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    s->wait_policy.store(policy);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Overrides the host wait policy for synchronizing this event
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendEventSetWaitPolicy(backend_event_t event, backend_wait_policy policy) - backend_api.h
+ */
+inline backend_error_t backendEventSetWaitPolicy(backend_event_t event, backend_wait_policy policy) {
+    if (event == NULL || policy < BACKEND_WAIT_DEFAULT || policy > BACKEND_WAIT_ADAPTIVE) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Event* e = backend_detail::lookupEvent(event);
+    if (e == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    e->wait_policy.store(policy);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports cumulative host wait time per mode; optionally resets the counters
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendGetWaitStats(backend_wait_stats* stats, int reset) - backend_api.h
+ */
+inline backend_error_t backendGetWaitStats(backend_wait_stats* stats, int reset) {
+    if (stats == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::WaitStats& s = backend_detail::waitStats();
+    uint64_t ns[3];
+    uint64_t waits[3];
+    for (int i = 0; i < 3; ++i) {
+        ns[i] = reset ? s.ns[i].exchange(0) : s.ns[i].load();
+        waits[i] = reset ? s.waits[i].exchange(0) : s.waits[i].load();
+    }
+    stats->spin_ns = ns[backend_detail::MODE_SPIN];
+    stats->spin_waits = waits[backend_detail::MODE_SPIN];
+    stats->yield_ns = ns[backend_detail::MODE_YIELD];
+    stats->yield_waits = waits[backend_detail::MODE_YIELD];
+    stats->block_ns = ns[backend_detail::MODE_BLOCK];
+    stats->block_waits = waits[backend_detail::MODE_BLOCK];
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Maps a launchable function to the host callable that runs one block of it
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Lock-free lookup table probed on every launch; re-registering a function replaces its callable for later launches. BACKEND_ERROR_OUT_OF_MEMORY once 4096 functions are registered
+ * TARGET_API_REF: backendRegisterHostKernel(const void* func, backend_host_kernel_t kernel) - backend_api.h
+ */
+inline backend_error_t backendRegisterHostKernel(const void* func, backend_host_kernel_t kernel) {
+    if (func == NULL || kernel == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    if (!backend_detail::hostKernels().insert(func, kernel)) {
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Declares the static shared memory every block of a registered kernel uses, exposed as backend_kernel_context::sharedMem
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Stored beside the callable and read at launch, so launches already enqueued or captured keep the size they were launched with. Static plus dynamic shared memory is limited to 48 KiB per block
+ * TARGET_API_REF: backendFuncSetStaticSharedMem(const void* func, size_t bytes) - backend_api.h
+ */
+inline backend_error_t backendFuncSetStaticSharedMem(const void* func, size_t bytes) {
+    if (func == NULL || bytes > backend_detail::kMaxSharedMemPerBlock) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    if (!backend_detail::hostKernels().setStaticShared(func, bytes)) {
+        return BACKEND_ERROR_INVALID_DEVICE_FUNCTION;
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports a registered kernel's static shared memory and the largest dynamic sharedMem a launch of it may pass
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * TARGET_API_REF: backendFuncGetAttributes(backend_func_attributes* attr, const void* func) - backend_api.h
+ */
+inline backend_error_t backendFuncGetAttributes(backend_func_attributes* attr, const void* func) {
+    if (attr == NULL || func == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::HostKernel kernel;
+    if (!backend_detail::hostKernels().find(func, &kernel)) {
+        return BACKEND_ERROR_INVALID_DEVICE_FUNCTION;
+    }
+    size_t used = backend_detail::kernelSharedBytes(kernel.static_shared, 0);
+    attr->sharedSizeBytes = kernel.static_shared;
+    attr->maxDynamicSharedSizeBytes =
+        used < backend_detail::kMaxSharedMemPerBlock ? backend_detail::kMaxSharedMemPerBlock - used : 0;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Chooses how the host is split into devices; must be called before any device, stream or allocation is used
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: "N" makes N devices over equal runs of the online CPUs, "numa" one per NUMA node with CPUs, "l3" one per L3 cache instance; each device gets its own pinned worker pools and memory arena. Without this call the BACKEND_DEVICES environment variable is used, else one device spans the host. Fails once the partition is fixed
+ * TARGET_API_REF: backendConfigureDevices(const char* partition) - backend_api.h
+ */
+inline backend_error_t backendConfigureDevices(const char* partition) {
+    std::vector<backend_detail::DevicePartition> parts;
+    if (partition == NULL || !backend_detail::partitionHost(partition, &parts)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::DeviceConfig& config = backend_detail::deviceConfig();
+    std::lock_guard<std::mutex> guard(config.lock);
+    if (config.fixed) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    config.partition = partition;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Makes `device` the calling thread's current device: new streams and allocations go to it
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: The current device is a thread-local index, so setting and reading it takes no lock; threads start on device 0
+ * TARGET_API_REF: backendSetDevice(int device) - backend_api.h
+ */
+inline backend_error_t backendSetDevice(int device) {
+    if (!backend_detail::validDevice(device)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::currentDeviceIndex() = device;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: The calling thread's current device
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendGetDevice(int* device) - backend_api.h
+ */
+inline backend_error_t backendGetDevice(int* device) {
+    if (device == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *device = backend_detail::currentDeviceIndex();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Number of devices the host is partitioned into; one unless configured otherwise
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * TARGET_API_REF: backendGetDeviceCount(int* count) - backend_api.h
+ */
+inline backend_error_t backendGetDeviceCount(int* count) {
+    if (count == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *count = static_cast<int>(backend_detail::deviceSnapshot()->devices.size());
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Points props at a device's properties, which stay valid and unchanged for the life of the process
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: The first query reads /proc and sysfs once under call_once; every later one is an acquire load of the published snapshot, so callers need not cache the result themselves
+ * TARGET_API_REF: backendGetDeviceProperties(const backend_device_properties** props, int device) - backend_api.h
+ */
+inline backend_error_t backendGetDeviceProperties(const backend_device_properties** props, int device) {
+    if (props == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    const backend_detail::DeviceSnapshot* snapshot = backend_detail::deviceSnapshot();
+    if (device < 0 || static_cast<size_t>(device) >= snapshot->devices.size()) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *props = &snapshot->devices[device];
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: DEVICE_QUERY
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Re-reads device properties, e.g. after CPUs or memory were hot-plugged, and publishes them for later queries
+ * AI_DEPENDENCIES: INIT_HOOKS
+ * AI_STRATEGY: Builds a new snapshot and swaps the published pointer; properties handed out earlier keep their old values and stay valid. The worker pools keep the size they started with
+ * TARGET_API_REF: backendRefreshDeviceProperties() - backend_api.h
+ */
+inline backend_error_t backendRefreshDeviceProperties() {
+    backend_detail::publishDeviceSnapshot();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Blocks of a registered kernel that run at once on the current device for a given block size and dynamic shared memory
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_STRATEGY: One block per worker while the block's shared memory (static plus sharedMem) fits in L1d; larger tiles are limited by how many fit in each L2 instance, using cache sizes read once from sysfs. Block size does not change residency on the host, since a block's threads run in sequence on its worker. 0 if the launch would be rejected
+ * TARGET_API_REF: backendOccupancyMaxActiveBlocks(unsigned int* blocks, const void* func, unsigned int blockSize, size_t sharedMem) - backend_api.h
+ */
+inline backend_error_t backendOccupancyMaxActiveBlocks(unsigned int* blocks, const void* func,
+                                                       unsigned int blockSize, size_t sharedMem) {
+    if (blocks == NULL || func == NULL || blockSize == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::HostKernel kernel;
+    if (!backend_detail::hostKernels().find(func, &kernel)) {
+        return BACKEND_ERROR_INVALID_DEVICE_FUNCTION;
+    }
+    size_t shared = backend_detail::kernelSharedBytes(kernel.static_shared, sharedMem);
+    *blocks = shared > backend_detail::kMaxSharedMemPerBlock ? 0 : backend_detail::occupancyLimit(shared);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Block and grid size for a one-thread-per-element launch over n elements that the backend expects to finish soonest
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_STRATEGY: Tries power-of-two block sizes from BACKEND_LANE_WIDTH to 1024 and models each as rounds of backendOccupancyMaxActiveBlocks blocks, every block costing its threads plus a fixed dispatch overhead; the cheapest wins, the smaller block on ties. Big problems get large blocks, small ones enough blocks to occupy every worker. Lane kernels are specialised on their BlockSize and should keep it
+ * TARGET_API_REF: backendSuggestLaunchConfig(backend_launch_config* config, const void* func, size_t sharedMem, size_t n) - backend_api.h
+ */
+inline backend_error_t backendSuggestLaunchConfig(backend_launch_config* config, const void* func,
+                                                  size_t sharedMem, size_t n) {
+    if (config == NULL || n == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    unsigned int active = 0;
+    backend_error_t result = backendOccupancyMaxActiveBlocks(&active, func, 1, sharedMem);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    if (active == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    uint64_t best_cost = UINT64_MAX;
+    for (unsigned int size = BACKEND_LANE_WIDTH; size <= backend_detail::kSuggestMaxBlockSize; size *= 2) {
+        uint64_t grid = (static_cast<uint64_t>(n) + size - 1) / size;
+        if (grid > UINT_MAX) {
+            continue;
+        }
+        uint64_t cost = backend_detail::launchRounds(grid, active) *
+                        (size + backend_detail::kBlockOverheadThreads);
+        if (cost < best_cost) {
+            best_cost = cost;
+            config->blockSize = size;
+            config->gridSize = static_cast<unsigned int>(grid);
+        }
+    }
+    if (best_cost == UINT64_MAX) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Host callable that runs one block of a lane kernel, with the block's threads as SIMD lanes
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Body supplies Params, load(ctx, args) (once per block), live(params, ctx) (threads that do work, in linear order) and thread(params, ctx, t, active) (thread t, linear in the block). Every group of Width lanes runs as one vector loop, including the last, partial group; there active is false for lanes at or past live, and the body must not load or store for them (guard with if (active) or a select, which the compiler masks). A block of exactly BlockSize live threads takes loops specialised on BlockSize. Lanes must not communicate within a block
+ * TARGET_API_REF: backendLaneKernel<Body, BlockSize, Width>(const backend_kernel_context* ctx, void** args) - backend_api.h
+ */
+template <typename Body, unsigned int BlockSize, unsigned int Width = BACKEND_LANE_WIDTH>
+inline void backendLaneKernel(const backend_kernel_context* ctx, void** args) {
+    const typename Body::Params p = Body::load(ctx, args);
+    unsigned int threads = ctx->blockDim.x * ctx->blockDim.y * ctx->blockDim.z;
+    unsigned int live = Body::live(p, ctx);
+    if (live > threads) {
+        live = threads;
+    }
+    if (threads == BlockSize && live == BlockSize) {
+        backend_detail::runLaneBlock<Body, BlockSize, Width>(p, ctx);
+    } else {
+        backend_detail::runLaneGroups<Body, Width>(p, ctx, live);
+    }
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Registers Body as the host callable of func, executed as lane groups specialised for BlockSize threads per block
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Width defaults to BACKEND_LANE_WIDTH, the 32-bit lanes of the widest vector unit the translation unit is built for; launches with a different block size still run, without the specialised loops
+ * TARGET_API_REF: backendRegisterLaneKernel<Body, BlockSize, Width>(const void* func) - backend_api.h
+ */
+template <typename Body, unsigned int BlockSize, unsigned int Width = BACKEND_LANE_WIDTH>
+inline backend_error_t backendRegisterLaneKernel(const void* func) {
+    return backendRegisterHostKernel(func, &backendLaneKernel<Body, BlockSize, Width>);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Enqueues a stream-ordered kernel launch that runs the function's registered host callable once per block
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: At the stream head the grid is shared out to one participant per worker, each claiming chunks of block indices until none are left; the last one to finish resumes the stream. Single-block launches run inline on the draining worker. Unregistered functions fail with BACKEND_ERROR_INVALID_DEVICE_FUNCTION. Each block gets its static and sharedMem bytes from the running worker's reusable arena; launches over 48 KiB in total fail with BACKEND_ERROR_INVALID_VALUE. args must stay valid until the launch retires, or for the life of a captured graph
+ * TARGET_API_REF: backendLaunchKernel(const void* func, backend_dim3 grid, backend_dim3 block, void** args, size_t sharedMem, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendLaunchKernel(const void* func, backend_dim3 grid, backend_dim3 block,
+                                           void** args, size_t sharedMem, backend_stream_t stream) {
+    return backend_detail::launchKernel(func, grid, block, args, sharedMem, stream, false);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Enqueues count kernel launches, in array order, as a single stream operation
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: All descriptors are validated before anything is queued, so a bad one fails the whole call with nothing enqueued. The worker that reaches the batch runs its kernels back to back, every block inline, without returning to the scheduler; meant for many small kernels, as grids are not spread over the workers. Captured batches become a chain of kernel nodes
+ * TARGET_API_REF: backendLaunchKernelBatch(const backend_launch_params* launches, unsigned int count, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendLaunchKernelBatch(const backend_launch_params* launches, unsigned int count,
+                                                backend_stream_t stream) {
+    return backend_detail::launchKernelBatch(launches, count, stream);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Enqueues a kernel launch whose blocks all run at once, so the kernel may call backendGridSync between phases
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Each block gets its own thread of a cooperative pool sized like the workers, and a launch's blocks are queued back to back, which guarantees co-residency; grids larger than backendGetCooperativeGridLimit fail with BACKEND_ERROR_COOPERATIVE_LAUNCH_TOO_LARGE. Captures into graphs and saves like any kernel launch
+ * TARGET_API_REF: backendLaunchCooperativeKernel(const void* func, backend_dim3 grid, backend_dim3 block, void** args, size_t sharedMem, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendLaunchCooperativeKernel(const void* func, backend_dim3 grid, backend_dim3 block,
+                                                      void** args, size_t sharedMem, backend_stream_t stream) {
+    return backend_detail::launchKernel(func, grid, block, args, sharedMem, stream, true);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Typed kernel launch: kernel is a host function taking the block context and its own parameters, and args are passed by value
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: The kernel pointer and the arguments, converted to the kernel's parameter types, are packed at compile-time offsets into one aligned blob stored in the stream op, so nothing is boxed, nothing has to outlive the call, and each block gets its arguments from the pack with no per-argument indirection. Parameters must be trivially copyable and fit in 64 bytes with the kernel pointer (checked at compile time). The kernel needs no registration; a registered static shared size still applies. Typed launches capture and update like other kernels but cannot be saved to a graph file
+ * TARGET_API_REF: backendLaunch(void (*kernel)(const backend_kernel_context*, Params...), backend_dim3 grid, backend_dim3 block, size_t sharedMem, backend_stream_t stream, Params... args) - backend_api.h
+ */
+template <typename... Params>
+inline backend_error_t backendLaunch(void (*kernel)(const backend_kernel_context*, Params...),
+                                     backend_dim3 grid, backend_dim3 block, size_t sharedMem,
+                                     backend_stream_t stream,
+                                     typename backend_detail::NonDeduced<Params>::type... args) {
+    typedef backend_detail::PackedLaunch<Params...> Pack;
+    static_assert(sizeof(Pack) <= backend_detail::kPackedArgBytes,
+                  "typed launch arguments exceed 64 bytes; pass them through backendLaunchKernel");
+    static_assert(alignof(Pack) <= 16, "typed launch arguments need more than 16-byte alignment");
+#if !defined(__GNUC__) || defined(__clang__) || __GNUC__ >= 5
+    static_assert(std::is_trivially_copyable<Pack>::value,
+                  "typed launch arguments must be trivially copyable");
+#endif
+    if (kernel == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    Pack pack;
+    pack.kernel = kernel;
+    backend_detail::fillPack(&pack.args, args...);
+    return backend_detail::launchPackedKernel(reinterpret_cast<const void*>(kernel),
+                                              &backend_detail::runPacked<Params...>,
+                                              &pack, sizeof(pack), grid, block, sharedMem, stream);
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Largest grid, in blocks, that backendLaunchCooperativeKernel accepts
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * TARGET_API_REF: backendGetCooperativeGridLimit(unsigned int* blocks) - backend_api.h
+ */
+inline backend_error_t backendGetCooperativeGridLimit(unsigned int* blocks) {
+    if (blocks == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *blocks = backend_detail::workerCount();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Grid-wide barrier for host kernels: returns once every block of the cooperative launch has reached it, with their writes visible
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: Sense-reversing barrier in the launch; blocks spin for the adaptive window and then sleep on a futex, so an unbalanced phase does not burn every core. Every block must call it the same number of times. A single-block grid passes straight through; other launches that were not cooperative get BACKEND_ERROR_INVALID_VALUE
+ * TARGET_API_REF: backendGridSync(const backend_kernel_context* ctx) - backend_api.h
+ */
+inline backend_error_t backendGridSync(const backend_kernel_context* ctx) {
+    if (ctx == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    if (ctx->gridBarrier == NULL) {
+        bool single = ctx->gridDim.x == 1 && ctx->gridDim.y == 1 && ctx->gridDim.z == 1;
+        return single ? BACKEND_SUCCESS : BACKEND_ERROR_INVALID_VALUE;
+    }
+    static_cast<backend_detail::GridBarrier*>(ctx->gridBarrier)->wait();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: ERROR_HANDLING
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Called from a host kernel to fail its launch asynchronously; the launching stream reports error from its next backendStreamSynchronize or backendStreamQuery
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: HOST_KERNEL_V1
+ * AI_STRATEGY: One CAS on the stream's sticky error word; the first error raised on a stream wins. The kernel's remaining blocks and later work on the stream still run. error must be negative, BACKEND_ERROR_LAUNCH_FAILURE unless the kernel has a more specific code
+ * TARGET_API_REF: backendKernelRaiseError(const backend_kernel_context* ctx, backend_error_t error) - backend_api.h
+ */
+inline backend_error_t backendKernelRaiseError(const backend_kernel_context* ctx, backend_error_t error) {
+    if (ctx == NULL || ctx->streamError == NULL || error >= 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::raiseStreamError(static_cast<std::atomic<int>*>(ctx->streamError), error);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Creates a lock-free work queue of at least capacity items for a persistent kernel to pull from
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * AI_STRATEGY: Bounded ring of capacity rounded up to a power of two; items are opaque pointers owned by the caller
+ * TARGET_API_REF: backendWorkQueueCreate(backend_work_queue_t* queue, unsigned int capacity) - backend_api.h
+ */
+inline backend_error_t backendWorkQueueCreate(backend_work_queue_t* queue, unsigned int capacity) {
+    if (queue == NULL || capacity == 0 || capacity > (1u << 30)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    uint64_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    backend_detail::WorkQueue* q = backend_detail::workQueuePool().acquire();
+    if (q == NULL) {
+        *queue = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    q->cells = new (std::nothrow) backend_detail::WorkQueue::Cell[size];
+    if (q->cells == NULL) {
+        backend_detail::workQueuePool().retire(q);
+        backend_detail::workQueuePool().recycle(q);
+        *queue = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    for (uint64_t i = 0; i < size; ++i) {
+        q->cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    q->mask = size - 1;
+    q->tail.store(0, std::memory_order_relaxed);
+    q->head.store(0, std::memory_order_relaxed);
+    q->closed.store(false, std::memory_order_release);
+    *queue = backend_detail::handlePointer(q->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys a work queue; the persistent kernel using it must have returned (synchronize its stream first)
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * TARGET_API_REF: backendWorkQueueDestroy(backend_work_queue_t queue) - backend_api.h
+ */
+inline backend_error_t backendWorkQueueDestroy(backend_work_queue_t queue) {
+    if (queue == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::WorkQueue* q = backend_detail::lookupWorkQueue(queue);
+    if (q == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::workQueuePool().retire(q);
+    delete[] q->cells;
+    q->cells = NULL;
+    backend_detail::workQueuePool().recycle(q);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Host side of a persistent kernel: hands one work item to the kernel's blocks without a launch
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * AI_STRATEGY: One CAS on the ring's tail, then a wake that only enters the kernel when a block is asleep. Never blocks: a full queue returns BACKEND_ERROR_NOT_READY, a closed one BACKEND_ERROR_WORK_QUEUE_CLOSED. Safe from any number of threads
+ * TARGET_API_REF: backendWorkQueuePush(backend_work_queue_t queue, void* item) - backend_api.h
+ */
+inline backend_error_t backendWorkQueuePush(backend_work_queue_t queue, void* item) {
+    if (queue == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::WorkQueue* q = backend_detail::lookupWorkQueue(queue);
+    if (q == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    if (q->closed.load(std::memory_order_acquire)) {
+        return BACKEND_ERROR_WORK_QUEUE_CLOSED;
+    }
+    if (!q->push(item)) {
+        return BACKEND_ERROR_NOT_READY;
+    }
+    q->ready.wake();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Shutdown signal for a persistent kernel: blocks finish the items already queued, then their pops fail and the kernel can return
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * TARGET_API_REF: backendWorkQueueClose(backend_work_queue_t queue) - backend_api.h
+ */
+inline backend_error_t backendWorkQueueClose(backend_work_queue_t queue) {
+    if (queue == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::WorkQueue* q = backend_detail::lookupWorkQueue(queue);
+    if (q == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    q->closed.store(true, std::memory_order_release);
+    q->ready.wake();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Kernel side of a persistent kernel: takes the next work item, waiting for one if the queue is empty
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * AI_STRATEGY: An idle block spins for the adaptive window and then sleeps until a push or the close, so a hot kernel picks items up without a syscall and an idle one costs no CPU. Returns BACKEND_ERROR_WORK_QUEUE_CLOSED once the queue is closed and drained, the kernel's cue to return
+ * TARGET_API_REF: backendWorkQueuePop(backend_work_queue_t queue, void** item) - backend_api.h
+ */
+inline backend_error_t backendWorkQueuePop(backend_work_queue_t queue, void** item) {
+    if (queue == NULL || item == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::WorkQueue* q = backend_detail::lookupWorkQueue(queue);
+    if (q == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    return q->waitPop(item) ? BACKEND_SUCCESS : BACKEND_ERROR_WORK_QUEUE_CLOSED;
+}
+
+/*
+ * AI_PHASE: KERNEL_DISPATCH
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Launches a persistent kernel: workers blocks that stay resident and pull items from queue (ctx->workQueue) until it is closed
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: PERSISTENT_KERNEL_V1
+ * AI_STRATEGY: A cooperative launch of workers one-thread blocks, so every block has its own thread and may also grid-sync. The launch holds its stream until the kernel returns, so synchronize the stream after backendWorkQueueClose to join it. While it runs it occupies workers threads of the cooperative pool; cooperative launches that need more wait for it to end
+ * TARGET_API_REF: backendLaunchPersistentKernel(const void* func, unsigned int workers, backend_work_queue_t queue, void** args, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendLaunchPersistentKernel(const void* func, unsigned int workers,
+                                                     backend_work_queue_t queue, void** args,
+                                                     backend_stream_t stream) {
+    if (workers == 0 || queue == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    if (backend_detail::lookupWorkQueue(queue) == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_dim3 grid = { workers, 1, 1 };
+    backend_dim3 block = { 1, 1, 1 };
+    return backend_detail::launchKernel(func, grid, block, args, 0, stream, true, queue);
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Puts the stream into capture mode; enqueued copies, fills, kernels and callbacks become nodes of a new graph instead of executing
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * AI_PATTERN: STREAM_CAPTURE_V1
+ * AI_STRATEGY: The graph handle is returned immediately but cannot be instantiated until backendStreamEndCapture; other streams join through events recorded during the capture
+ * TARGET_API_REF: backendStreamBeginCapture(backend_stream_t stream, backend_graph_t* graph) - backend_api.h
+ */
+inline backend_error_t backendStreamBeginCapture(backend_stream_t stream, backend_graph_t* graph) {
+    if (stream == NULL || graph == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(s->lock);
+    if (s->capture != NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Graph* g = backend_detail::graphPool().acquire();
+    if (g == NULL) {
+        *graph = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    g->reset();
+    g->origin = s;
+    g->members.push_back(s);
+    g->capturing = true;
+    s->capture = g;
+    s->capture_tail.clear();
+    *graph = backend_detail::handlePointer(g->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Ends the capture begun on this stream, detaching every stream that joined it, and returns the captured graph
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, EVENT_MANAGEMENT
+ * AI_PATTERN: STREAM_CAPTURE_V1
+ * AI_STRATEGY: An invalidated capture is discarded and reported as BACKEND_ERROR_CAPTURE_INVALIDATED
+ * TARGET_API_REF: backendStreamEndCapture(backend_stream_t stream, backend_graph_t* graph) - backend_api.h
+ */
+inline backend_error_t backendStreamEndCapture(backend_stream_t stream, backend_graph_t* graph) {
+    if (stream == NULL || graph == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::Graph* g;
+    {
+        std::lock_guard<std::mutex> guard(s->lock);
+        g = s->capture;
+        if (g == NULL || g->origin != s) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+    }
+    std::vector<backend_detail::Stream*> members;
+    std::vector<backend_detail::Event*> events;
+    bool invalidated;
+    {
+        std::lock_guard<std::mutex> guard(g->lock);
+        g->capturing = false;
+        members.swap(g->members);
+        events.swap(g->captured_events);
+        invalidated = g->invalidated;
+    }
+    for (size_t i = 0; i < members.size(); ++i) {
+        std::lock_guard<std::mutex> guard(members[i]->lock);
+        members[i]->capture = NULL;
+        members[i]->capture_tail.clear();
+    }
+    for (size_t i = 0; i < events.size(); ++i) {
+        {
+            std::lock_guard<std::mutex> guard(events[i]->lock);
+            if (events[i]->capture_graph == g) {
+                events[i]->capture_graph = NULL;
+                events[i]->capture_deps.clear();
+            }
+        }
+        backend_detail::releaseEvent(events[i]);
+    }
+    if (invalidated) {
+        {
+            std::lock_guard<std::mutex> guard(g->lock);
+            backend_detail::releaseConditionals(&g->conditionals);
+        }
+        backend_detail::graphPool().retire(g);
+        backend_detail::graphPool().recycle(g);
+        *graph = NULL;
+        return BACKEND_ERROR_CAPTURE_INVALIDATED;
+    }
+    *graph = backend_detail::handlePointer(g->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports whether the stream is capturing, either as the origin or as a joined stream
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendStreamIsCapturing(backend_stream_t stream, int* capturing) - backend_api.h
+ */
+inline backend_error_t backendStreamIsCapturing(backend_stream_t stream, int* capturing) {
+    if (stream == NULL || capturing == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(s->lock);
+    *capturing = s->capture != NULL ? 1 : 0;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports the number of nodes in a graph
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendGraphGetNodeCount(backend_graph_t graph, size_t* count) - backend_api.h
+ */
+inline backend_error_t backendGraphGetNodeCount(backend_graph_t graph, size_t* count) {
+    if (graph == NULL || count == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Graph* g = backend_detail::lookupGraph(graph);
+    if (g == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(g->lock);
+    *count = g->nodes.size();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys a graph that is not being captured; executable graphs instantiated from it are unaffected
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendGraphDestroy(backend_graph_t graph) - backend_api.h
+ */
+inline backend_error_t backendGraphDestroy(backend_graph_t graph) {
+    if (graph == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Graph* g = backend_detail::lookupGraph(graph);
+    if (g == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    {
+        std::lock_guard<std::mutex> guard(g->lock);
+        if (g->capturing) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+        backend_detail::releaseConditionals(&g->conditionals);
+    }
+    backend_detail::graphPool().retire(g);
+    backend_detail::graphPool().recycle(g);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Creates a conditional value owned by a graph, for conditional nodes of that graph or of graphs nested in it
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * AI_STRATEGY: The value starts at defaultValue; with BACKEND_GRAPH_COND_ASSIGN_DEFAULT it is reset to defaultValue at every launch of an executable graph using it. Valid while any graph or executable graph using it exists
+ * TARGET_API_REF: backendGraphConditionalCreate(backend_graph_conditional_t* cond, backend_graph_t graph, unsigned int defaultValue, unsigned int flags) - backend_api.h
+ */
+inline backend_error_t backendGraphConditionalCreate(backend_graph_conditional_t* cond, backend_graph_t graph,
+                                                     unsigned int defaultValue, unsigned int flags) {
+    if (cond == NULL || graph == NULL || (flags & ~BACKEND_GRAPH_COND_ASSIGN_DEFAULT) != 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Graph* g = backend_detail::lookupGraph(graph);
+    if (g == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::GraphConditional* c = backend_detail::graphConditionalPool().acquire();
+    if (c == NULL) {
+        *cond = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    c->value = defaultValue;
+    c->default_value = defaultValue;
+    c->flags = flags;
+    c->refs.store(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard(g->lock);
+        g->conditionals.push_back(c);
+    }
+    *cond = backend_detail::handlePointer(c->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Sets a conditional value; meant to be called from a node of the graph (a callback or kernel) that precedes the conditional node
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * AI_STRATEGY: A plain store: graph dependencies order it before the conditional node reads the value, and the end of a body run orders it before a while loop re-checks it
+ * TARGET_API_REF: backendGraphSetConditional(backend_graph_conditional_t cond, unsigned int value) - backend_api.h
+ */
+inline backend_error_t backendGraphSetConditional(backend_graph_conditional_t cond, unsigned int value) {
+    if (cond == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphConditional* c = backend_detail::lookupGraphConditional(cond);
+    if (c == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    c->value = value;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Returns the address of a conditional value so copy, fill and kernel nodes can write it directly
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * TARGET_API_REF: backendGraphConditionalGetPointer(backend_graph_conditional_t cond, unsigned int** value) - backend_api.h
+ */
+inline backend_error_t backendGraphConditionalGetPointer(backend_graph_conditional_t cond, unsigned int** value) {
+    if (cond == NULL || value == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphConditional* c = backend_detail::lookupGraphConditional(cond);
+    if (c == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    *value = &c->value;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Appends an if or while node to the graph the stream is capturing; the body is a separately captured graph run when the conditional value is non-zero
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_CONDITIONAL_V1
+ * AI_STRATEGY: The body's nodes are snapshotted, so the body graph may be destroyed afterwards. At run time the node starts the body on the workers and completes when it ends; a while node re-checks the value after each pass and restarts the body on the same counters, with no host round-trip
+ * TARGET_API_REF: backendStreamAddConditionalNode(backend_stream_t stream, backend_graph_conditional_t cond, backend_graph_conditional_type type, backend_graph_t body) - backend_api.h
+ */
+inline backend_error_t backendStreamAddConditionalNode(backend_stream_t stream, backend_graph_conditional_t cond,
+                                                       backend_graph_conditional_type type, backend_graph_t body) {
+    if (stream == NULL || cond == NULL || body == NULL ||
+        (type != BACKEND_GRAPH_COND_IF && type != BACKEND_GRAPH_COND_WHILE)) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    backend_detail::GraphConditional* c = backend_detail::lookupGraphConditional(cond);
+    backend_detail::Graph* b = backend_detail::lookupGraph(body);
+    if (s == NULL || c == NULL || b == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::lock_guard<std::mutex> guard(s->lock);
+    if (s->capture == NULL || s->capture == b) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    std::shared_ptr<backend_detail::GraphBody> snapshot = std::make_shared<backend_detail::GraphBody>();
+    // Held across the append so destroying the body graph meanwhile is safe
+    std::vector<backend_detail::GraphConditional*> conds;
+    {
+        std::lock_guard<std::mutex> body_guard(b->lock);
+        if (b->capturing) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+        snapshot->nodes = b->nodes;
+        backend_detail::retainConditionals(&conds, std::vector<backend_detail::GraphConditional*>(1, c));
+        backend_detail::retainConditionals(&conds, b->conditionals);
+    }
+    backend_detail::GraphNode node;
+    node.op = backend_detail::makeOp(backend_detail::OP_CONDITIONAL);
+    node.op.cond = c;
+    node.op.cond_type = type;
+    node.body = snapshot;
+    backend_detail::appendCaptureNode(s, &node, conds);
+    backend_detail::releaseConditionals(&conds);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Builds an executable graph from a captured graph; the result is independent of the source graph
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_INSTANTIATE_V1
+ * AI_STRATEGY: Optimize a copy of the nodes (fuse contiguous copy/fill chains, drop transitive edges, order critical path first), then flatten into CSR successor lists with in-degrees and a root list so a launch only resets counters; conditional bodies are instantiated the same way
+ * TARGET_API_REF: backendGraphInstantiate(backend_graph_exec_t* exec, backend_graph_t graph) - backend_api.h
+ */
+inline backend_error_t backendGraphInstantiate(backend_graph_exec_t* exec, backend_graph_t graph) {
+    if (exec == NULL || graph == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::Graph* g = backend_detail::lookupGraph(graph);
+    if (g == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::vector<backend_detail::GraphNode> nodes;
+    std::vector<backend_detail::GraphConditional*> conditionals;
+    {
+        std::lock_guard<std::mutex> guard(g->lock);
+        if (g->capturing) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+        nodes = g->nodes;
+        backend_detail::retainConditionals(&conditionals, g->conditionals);
+    }
+    backend_detail::GraphExec* x = backend_detail::instantiateNodes(nodes);
+    if (x == NULL) {
+        backend_detail::releaseConditionals(&conditionals);
+        *exec = NULL;
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    x->conditionals.swap(conditionals);
+    *exec = backend_detail::handlePointer(x->handle);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Destroys an executable graph; launches already enqueued still run to completion
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendGraphExecDestroy(backend_graph_exec_t exec) - backend_api.h
+ */
+inline backend_error_t backendGraphExecDestroy(backend_graph_exec_t exec) {
+    if (exec == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphExec* x = backend_detail::lookupGraphExec(exec);
+    if (x == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::graphExecPool().retire(x);
+    backend_detail::releaseGraphExec(x);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Patches an executable graph with the node parameters of a graph of identical topology; later launches use the new parameters, launches already enqueued keep the old ones
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_EXEC_UPDATE_V1
+ * AI_STRATEGY: Compare node kinds and captured dependencies, rebuild the fused parameters through the exec's provenance table, then patch in place if no launch holds the table or swap in a new one; no optimizer pass runs. Conditional bodies are checked and patched the same way, all levels validated before any is installed. Returns BACKEND_ERROR_GRAPH_UPDATE_REJECTED if the topology differs, the new ranges break a fusion, or a conditional node uses a different conditional
+ * TARGET_API_REF: backendGraphExecUpdate(backend_graph_exec_t exec, backend_graph_t graph) - backend_api.h
+ */
+inline backend_error_t backendGraphExecUpdate(backend_graph_exec_t exec, backend_graph_t graph) {
+    if (exec == NULL || graph == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphExec* x = backend_detail::lookupGraphExec(exec);
+    if (x == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::Graph* g = backend_detail::lookupGraph(graph);
+    if (g == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    std::vector<backend_detail::GraphUpdate> plan;
+    {
+        std::lock_guard<std::mutex> guard(g->lock);
+        if (g->capturing) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+        if (!backend_detail::planGraphUpdate(x, g->nodes, &plan)) {
+            return BACKEND_ERROR_GRAPH_UPDATE_REJECTED;
+        }
+    }
+    for (size_t i = 0; i < plan.size(); ++i) {
+        backend_detail::installGraphParams(plan[i].exec, &plan[i].ops);
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Reports the number of nodes an executable graph runs per launch, after optimization
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * TARGET_API_REF: backendGraphExecGetNodeCount(backend_graph_exec_t exec, size_t* count) - backend_api.h
+ */
+inline backend_error_t backendGraphExecGetNodeCount(backend_graph_exec_t exec, size_t* count) {
+    if (exec == NULL || count == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphExec* x = backend_detail::lookupGraphExec(exec);
+    if (x == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    *count = x->indegree.size();
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Replays an executable graph on a stream as a single stream operation
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_LAUNCH_V1
+ * AI_STRATEGY: One enqueue per launch; when the launch reaches the stream head the roots go to the workers, each finished node releases its successors, and the last one returns the stream to the run queue
+ * TARGET_API_REF: backendGraphLaunch(backend_graph_exec_t exec, backend_stream_t stream) - backend_api.h
+ */
+inline backend_error_t backendGraphLaunch(backend_graph_exec_t exec, backend_stream_t stream) {
+    if (exec == NULL || stream == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphExec* x = backend_detail::lookupGraphExec(exec);
+    if (x == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::Stream* s = backend_detail::lookupStream(stream);
+    if (s == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::StreamOp op = backend_detail::makeOp(backend_detail::OP_GRAPH);
+    op.graph = x;
+    {
+        std::lock_guard<std::mutex> guard(x->lock);
+        op.params = x->params;
+        op.params->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    x->refs.fetch_add(1, std::memory_order_relaxed);
+    backend_error_t result = backend_detail::enqueueOp(s, op);
+    if (result != BACKEND_SUCCESS) {
+        backend_detail::releaseGraphParams(op.params);
+        backend_detail::releaseGraphExec(x);
+    }
+    return result;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Registers a kernel under a name so saved graphs can refer to it across processes
+ * AI_DEPENDENCIES: KERNEL_DISPATCH
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Re-registering a function renames it; a name already bound to another function is rejected
+ * TARGET_API_REF: backendRegisterKernel(const void* func, const char* name) - backend_api.h
+ */
+inline backend_error_t backendRegisterKernel(const void* func, const char* name) {
+    if (func == NULL || name == NULL || name[0] == '\0') {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::SymbolTable& table = backend_detail::symbols();
+    std::lock_guard<std::mutex> guard(table.lock);
+    backend_detail::KernelSymbol* entry = NULL;
+    for (size_t i = 0; i < table.kernels.size(); ++i) {
+        if (table.kernels[i].func != func && table.kernels[i].name == name) {
+            return BACKEND_ERROR_INVALID_VALUE;
+        }
+        if (table.kernels[i].func == func) {
+            entry = &table.kernels[i];
+        }
+    }
+    if (entry == NULL) {
+        table.kernels.push_back(backend_detail::KernelSymbol());
+        entry = &table.kernels.back();
+        entry->func = func;
+    }
+    entry->name = name;
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Names a memory region; graph nodes whose pointers fall inside it are saved as name plus offset
+ * AI_DEPENDENCIES: MEMORY_MANAGEMENT
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Registering an existing name rebinds it, which is how a restarted process points a loaded graph at its own buffers
+ * TARGET_API_REF: backendRegisterMemory(const char* name, void* base, size_t size) - backend_api.h
+ */
+inline backend_error_t backendRegisterMemory(const char* name, void* base, size_t size) {
+    if (name == NULL || name[0] == '\0' || base == NULL || size == 0) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::SymbolTable& table = backend_detail::symbols();
+    std::lock_guard<std::mutex> guard(table.lock);
+    for (size_t i = 0; i < table.regions.size(); ++i) {
+        if (table.regions[i].name == name) {
+            table.regions[i].base = static_cast<char*>(base);
+            table.regions[i].size = size;
+            return BACKEND_SUCCESS;
+        }
+    }
+    backend_detail::MemorySymbol region;
+    region.name = name;
+    region.base = static_cast<char*>(base);
+    region.size = size;
+    table.regions.push_back(region);
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Removes a named memory region, e.g. before its buffer is freed
+ * AI_DEPENDENCIES: MEMORY_MANAGEMENT
+ * AI_PATTERN: GRAPH_FILE_V1
+ * TARGET_API_REF: backendUnregisterMemory(const char* name) - backend_api.h
+ */
+inline backend_error_t backendUnregisterMemory(const char* name) {
+    if (name == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::SymbolTable& table = backend_detail::symbols();
+    std::lock_guard<std::mutex> guard(table.lock);
+    for (size_t i = 0; i < table.regions.size(); ++i) {
+        if (table.regions[i].name == name) {
+            table.regions.erase(table.regions.begin() + i);
+            return BACKEND_SUCCESS;
+        }
+    }
+    return BACKEND_ERROR_SYMBOL_NOT_FOUND;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Writes an executable graph (optimized topology, node parameters and update provenance) to a flat file another process can load without capturing or optimizing
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Fixed-size records in 8-byte aligned sections behind a header of offsets; kernels are stored by registered name and pointers as registered region plus offset. Graphs with callback or conditional nodes, or with unnamed kernels or pointers, are rejected with BACKEND_ERROR_SYMBOL_NOT_FOUND. The file is written beside the target and renamed into place
+ * TARGET_API_REF: backendGraphExecSave(backend_graph_exec_t exec, const char* path) - backend_api.h
+ */
+inline backend_error_t backendGraphExecSave(backend_graph_exec_t exec, const char* path) {
+    if (exec == NULL || path == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    backend_detail::GraphExec* x = backend_detail::lookupGraphExec(exec);
+    if (x == NULL) {
+        return BACKEND_ERROR_INVALID_HANDLE;
+    }
+    backend_detail::GraphParams* p;
+    {
+        std::lock_guard<std::mutex> guard(x->lock);
+        p = x->params;
+        p->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    backend_detail::GraphFileWriter writer;
+    std::vector<backend_detail::SavedOp> ops(p->ops.size());
+    bool named = true;
+    for (size_t i = 0; i < ops.size() && named; ++i) {
+        named = writer.encode(p->ops[i], &ops[i]);
+    }
+    backend_detail::releaseGraphParams(p);
+    if (!named) {
+        return BACKEND_ERROR_SYMBOL_NOT_FOUND;
+    }
+    std::vector<backend_detail::SavedSymbol> records;
+    std::string strings;
+    writer.appendSymbols(&records, &strings);
+
+    backend_detail::GraphFileBuilder file;
+    file.section(backend_detail::SECTION_OPS, ops.data(), ops.size());
+    file.section(backend_detail::SECTION_SUCC_BEGIN, x->succ_begin.data(), x->succ_begin.size());
+    file.section(backend_detail::SECTION_SUCCESSORS, x->successors.data(), x->successors.size());
+    file.section(backend_detail::SECTION_INDEGREE, x->indegree.data(), x->indegree.size());
+    file.section(backend_detail::SECTION_ROOTS, x->roots.data(), x->roots.size());
+    file.section(backend_detail::SECTION_SOURCE_KINDS, x->source_kinds.data(), x->source_kinds.size());
+    file.section(backend_detail::SECTION_SOURCE_DEP_BEGIN, x->source_dep_begin.data(), x->source_dep_begin.size());
+    file.section(backend_detail::SECTION_SOURCE_DEPS, x->source_deps.data(), x->source_deps.size());
+    file.section(backend_detail::SECTION_MEMBER_BEGIN, x->member_begin.data(), x->member_begin.size());
+    file.section(backend_detail::SECTION_MEMBERS, x->members.data(), x->members.size());
+    file.section(backend_detail::SECTION_SYMBOLS, records.data(), records.size());
+    file.section(backend_detail::SECTION_STRINGS, strings.data(), strings.size());
+    if (!backend_detail::writeGraphFile(path, file.finish())) {
+        return BACKEND_ERROR_FILE;
+    }
+    return BACKEND_SUCCESS;
+}
+
+/*
+ * AI_PHASE: GRAPH_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: HIGH
+ * AI_NOTE: Creates an executable graph from a file written by backendGraphExecSave, binding kernels and memory by the names registered in this process
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: GRAPH_FILE_V1
+ * AI_STRATEGY: Maps the file read-only and copies the sections straight into the exec's tables; no capture, optimizer or CSR build runs. Malformed or foreign files return BACKEND_ERROR_FILE, unknown names or ranges that no longer fit their region BACKEND_ERROR_SYMBOL_NOT_FOUND. The result can be launched and updated like any instantiated graph
+ * TARGET_API_REF: backendGraphExecLoad(backend_graph_exec_t* exec, const char* path) - backend_api.h
+ */
+inline backend_error_t backendGraphExecLoad(backend_graph_exec_t* exec, const char* path) {
+    if (exec == NULL || path == NULL) {
+        return BACKEND_ERROR_INVALID_VALUE;
+    }
+    *exec = NULL;
+    backend_detail::MappedFile mapped;
+    if (!mapped.open(path)) {
+        return BACKEND_ERROR_FILE;
+    }
+    backend_detail::GraphFileReader file(mapped);
+    if (!file.validate()) {
+        return BACKEND_ERROR_FILE;
+    }
+    backend_detail::GraphFileResolver resolver;
+    backend_error_t result = resolver.resolve(file);
+    if (result != BACKEND_SUCCESS) {
+        return result;
+    }
+    std::unique_ptr<backend_detail::GraphParams> params(new backend_detail::GraphParams());
+    const backend_detail::SavedOp* saved = file.section<backend_detail::SavedOp>(backend_detail::SECTION_OPS);
+    params->ops.resize(file.count(backend_detail::SECTION_OPS));
+    for (size_t i = 0; i < params->ops.size(); ++i) {
+        uint32_t kind = saved[i].kind;
+        if (kind != backend_detail::OP_COPY && kind != backend_detail::OP_MEMSET &&
+            kind != backend_detail::OP_KERNEL) {
+            return BACKEND_ERROR_FILE;
+        }
+        if (!resolver.decode(saved[i], &params->ops[i])) {
+            return BACKEND_ERROR_SYMBOL_NOT_FOUND;
+        }
+    }
+    backend_detail::GraphExec* x = backend_detail::graphExecPool().acquire();
+    if (x == NULL) {
+        return BACKEND_ERROR_OUT_OF_MEMORY;
+    }
+    file.copy(backend_detail::SECTION_SUCC_BEGIN, &x->succ_begin);
+    file.copy(backend_detail::SECTION_SUCCESSORS, &x->successors);
+    file.copy(backend_detail::SECTION_INDEGREE, &x->indegree);
+    file.copy(backend_detail::SECTION_ROOTS, &x->roots);
+    file.copy(backend_detail::SECTION_SOURCE_KINDS, &x->source_kinds);
+    file.copy(backend_detail::SECTION_SOURCE_DEP_BEGIN, &x->source_dep_begin);
+    file.copy(backend_detail::SECTION_SOURCE_DEPS, &x->source_deps);
+    file.copy(backend_detail::SECTION_MEMBER_BEGIN, &x->member_begin);
+    file.copy(backend_detail::SECTION_MEMBERS, &x->members);
+    x->params = params.release();
+    x->bodies.assign(x->indegree.size(), NULL);
+    x->refs.store(1, std::memory_order_relaxed);
+    if (x->params->ops.size() != x->indegree.size() || !backend_detail::graphTablesConsistent(x)) {
+        backend_detail::graphExecPool().retire(x);
+        backend_detail::releaseGraphExec(x);
+        return BACKEND_ERROR_FILE;
+    }
+    *exec = backend_detail::handlePointer(x->handle);
+    return BACKEND_SUCCESS;
+}
+
+#if defined(BACKEND_HAS_COROUTINES)
+
+/*
+ * Coroutine awaitables (C++20). `co_await backend_stream_ready(stream)`
+ * suspends until all work queued on the stream so far has retired, and
+ * `co_await backend_event_done(event)` until the event's latest record has
+ * completed; both yield a backend_error_t. No thread waits: the stream
+ * case queues a host callback, the event case a continuation on the
+ * event, and either hands the coroutine to an executor when it fires. The
+ * default executor resumes it as a task on the callback dispatchers; a
+ * backend_resume_queue lets one thread of the caller's own run every
+ * resumption, so that thread can drive thousands of pipelines.
+ */
+
+// Where an awaiting coroutine resumes: post must arrange for
+// coroutine.resume() on some thread, and return without running it. A
+// NULL post resumes on the callback dispatchers.
+struct backend_executor {
+    void (*post)(void* context, std::coroutine_handle<> coroutine);
+    void* context;
+};
+
+namespace backend_detail {
+
+inline void resumeCoroutine(void* address) {
+    std::coroutine_handle<>::from_address(address).resume();
+}
+
+inline void resumeOn(const backend_executor& executor, std::coroutine_handle<> coroutine) {
+    if (executor.post != NULL) {
+        executor.post(executor.context, coroutine);
+    } else {
+        dispatchers().submit(resumeCoroutine, coroutine.address());
+    }
+}
+
+} // namespace backend_detail
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Awaitable that resumes the coroutine once all work queued on the stream before the co_await has retired; yields the stream's pending async error, without taking it, or BACKEND_SUCCESS
+ * AI_DEPENDENCIES: STREAM_TRANSLATION, ERROR_HANDLING
+ * AI_PATTERN: COROUTINE_AWAIT_V1
+ * AI_STRATEGY: An idle stream with no pending error does not suspend. Otherwise a host callback is queued whose dispatcher hands the coroutine to the executor, so the callback retires before the coroutine runs and may synchronize the same stream. A capturing stream yields BACKEND_ERROR_INVALID_VALUE
+ * TARGET_API_REF: backend_stream_ready(backend_stream_t stream, backend_executor executor) - backend_api.h
+ */
+class backend_stream_ready {
+public:
+    explicit backend_stream_ready(backend_stream_t stream, backend_executor executor = backend_executor())
+        : stream_(stream), executor_(executor), result_(BACKEND_SUCCESS) {}
+
+    bool await_ready() const {
+        backend_detail::Stream* s = stream_ != NULL ? backend_detail::lookupStream(stream_) : NULL;
+        return s != NULL && s->error.load(std::memory_order_relaxed) == 0 &&
+               backend_detail::statusIdle(s->status.load(std::memory_order_acquire));
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+        coroutine_ = coroutine;
+        int capturing = 0;
+        backend_error_t result = backendStreamIsCapturing(stream_, &capturing);
+        if (result == BACKEND_SUCCESS && capturing) {
+            result = BACKEND_ERROR_INVALID_VALUE;
+        }
+        if (result != BACKEND_SUCCESS) {
+            result_ = result;
+            return false;
+        }
+        // Once queued, the callback may resume and free the frame at once
+        result = backendStreamAddCallback(stream_, &backend_stream_ready::drained, this);
+        if (result != BACKEND_SUCCESS) {
+            result_ = result;
+            return false;
+        }
+        return true;
+    }
+
+    backend_error_t await_resume() const {
+        return result_;
+    }
+
+private:
+    static void drained(backend_stream_t, backend_error_t status, void* self) {
+        backend_stream_ready* awaiter = static_cast<backend_stream_ready*>(self);
+        awaiter->result_ = status;
+        backend_detail::resumeOn(awaiter->executor_, awaiter->coroutine_);
+    }
+
+    backend_stream_t stream_;
+    backend_executor executor_;
+    backend_error_t result_;
+    std::coroutine_handle<> coroutine_;
+};
+
+/*
+ * AI_PHASE: EVENT_MANAGEMENT
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: MEDIUM
+ * AI_NOTE: Awaitable that resumes the coroutine once the event's latest record before the co_await has completed; yields BACKEND_SUCCESS, or BACKEND_ERROR_INVALID_HANDLE for a bad event
+ * AI_DEPENDENCIES: EVENT_MANAGEMENT
+ * AI_PATTERN: COROUTINE_AWAIT_V1
+ * AI_STRATEGY: A completed or unrecorded event does not suspend. Otherwise a continuation is added to the event, holding a reference so destroying the event meanwhile is safe; the worker that completes the event hands the coroutine to the executor
+ * TARGET_API_REF: backend_event_done(backend_event_t event, backend_executor executor) - backend_api.h
+ */
+class backend_event_done {
+public:
+    explicit backend_event_done(backend_event_t event, backend_executor executor = backend_executor())
+        : event_(event), executor_(executor), result_(BACKEND_SUCCESS) {}
+
+    bool await_ready() {
+        backend_detail::Event* e = event_ != NULL ? backend_detail::lookupEvent(event_) : NULL;
+        if (e == NULL) {
+            result_ = event_ != NULL ? BACKEND_ERROR_INVALID_HANDLE : BACKEND_ERROR_INVALID_VALUE;
+            return true;
+        }
+        return backend_detail::statusIdle(e->status.load(std::memory_order_acquire));
+    }
+
+    bool await_suspend(std::coroutine_handle<> coroutine) {
+        coroutine_ = coroutine;
+        backend_detail::Event* e = backend_detail::lookupEvent(event_);
+        if (e == NULL) {
+            result_ = BACKEND_ERROR_INVALID_HANDLE;
+            return false;
+        }
+        return backend_detail::notifyOnEvent(e, &backend_event_done::completed, this);
+    }
+
+    backend_error_t await_resume() const {
+        return result_;
+    }
+
+private:
+    static void completed(void* self) {
+        backend_event_done* awaiter = static_cast<backend_event_done*>(self);
+        backend_detail::resumeOn(awaiter->executor_, awaiter->coroutine_);
+    }
+
+    backend_event_t event_;
+    backend_executor executor_;
+    backend_error_t result_;
+    std::coroutine_handle<> coroutine_;
+};
+
+/*
+ * AI_PHASE: STREAM_TRANSLATION
+ * AI_STATUS: IMPLEMENTED
+ * AI_COMPLEXITY: LOW
+ * AI_NOTE: Executor that collects resumptions for one caller thread: pass executor() to the awaitables and call run_one/poll from the thread that should resume them
+ * AI_DEPENDENCIES: STREAM_TRANSLATION
+ * AI_PATTERN: COROUTINE_AWAIT_V1
+ * AI_STRATEGY: A locked list swapped out whole, so the driving thread takes every ready coroutine with one lock and resumes them without holding it. post notifies while still holding the lock, so once a coroutine is visible to the driving thread the posting worker touches the queue no more. The queue must outlive every post: destroy it only after every coroutine awaiting through its executor has been resumed
+ * TARGET_API_REF: backend_resume_queue::executor() - backend_api.h
+ */
+class backend_resume_queue {
+public:
+    backend_resume_queue() {}
+
+    backend_executor executor() {
+        backend_executor e = { &backend_resume_queue::post, this };
+        return e;
+    }
+
+    // Resumes every coroutine posted so far; returns how many.
+    size_t poll() {
+        std::vector<std::coroutine_handle<> > batch;
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            batch.swap(ready_);
+        }
+        for (size_t i = 0; i < batch.size(); ++i) {
+            batch[i].resume();
+        }
+        return batch.size();
+    }
+
+    // Waits until at least one coroutine has been posted, then polls.
+    size_t run_one() {
+        {
+            std::unique_lock<std::mutex> guard(lock_);
+            posted_.wait(guard, [this] { return !ready_.empty(); });
+        }
+        return poll();
+    }
+
+private:
+    backend_resume_queue(const backend_resume_queue&);
+    backend_resume_queue& operator=(const backend_resume_queue&);
+
+    static void post(void* context, std::coroutine_handle<> coroutine) {
+        backend_resume_queue* queue = static_cast<backend_resume_queue*>(context);
+        // Notify under the lock: once the lock is dropped the driving
+        // thread may resume the coroutine, finish and destroy the queue
+        std::lock_guard<std::mutex> guard(queue->lock_);
+        if (queue->ready_.empty()) {
+            queue->posted_.notify_one();
+        }
+        queue->ready_.push_back(coroutine);
+    }
+
+    std::mutex lock_;
+    std::condition_variable posted_;
+    std::vector<std::coroutine_handle<> > ready_;
+};
+
+#endif /* BACKEND_HAS_COROUTINES */
+
+#endif /* ACD_BACKEND_API_H */